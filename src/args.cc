@@ -25,6 +25,11 @@ const char* Args::GetValue(const std::string& name) const {
   return search != options_.end() ? search->second : nullptr;
 }
 
+std::vector<const char*> Args::GetValues(const std::string& name) const {
+  auto search = values_.find(name);
+  return search != values_.end() ? search->second : std::vector<const char*>();
+}
+
 bool Args::IsFlag(const std::string& name) const { return flags_.count(name); }
 
 bool Args::IsOption(const std::string& name) const { return options_.count(name); }
@@ -32,6 +37,7 @@ bool Args::IsOption(const std::string& name) const { return options_.count(name)
 bool Args::ResolveArgs(const char* const* argv) {
   flags_.clear();
   options_.clear();
+  values_.clear();
   if (argv == nullptr || *argv == nullptr || **argv == '\0') return false;
 
   const char* next;
@@ -55,7 +61,14 @@ bool Args::ResolveArgs(const char* const* argv) {
     // line multiple the same options (with different values) - in such case
     // always the last one provided will be considered.
     options_[name] = next;
+    std::vector<const char*>& values = values_[name];
+    values.assign(1, next);
     arg = *(++argv);
+    // The following values up to the next argument belong to the option too.
+    while ((next = *(argv + 1)) != nullptr && *next != '\0' && strncmp(next, "--", 2) != 0) {
+      values.push_back(next);
+      arg = *(++argv);
+    }
   }
   return true;
 }
@@ -20,6 +20,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace util {
 
@@ -32,6 +33,10 @@ class Args {
   // does not exist in the  set represented by this object, return nullptr.
   const char* GetValue(const std::string& name) const;
 
+  // Get every value following --<name>, up to the next argument, such as both
+  // of `--generate 100 50`. Empty if there is no such option.
+  std::vector<const char*> GetValues(const std::string& name) const;
+
   // Check whenever exist flag with given `name`.
   bool IsFlag(const std::string& name) const;
 
@@ -49,6 +54,7 @@ class Args {
  private:
   std::set<std::string> flags_;
   std::map<std::string, const char*> options_;
+  std::map<std::string, std::vector<const char*>> values_;
 };
 
 }  // namespace util
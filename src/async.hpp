@@ -0,0 +1,204 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_ASYNC_HPP_
+#define SDIZO_ASYNC_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "graph.hpp"
+#include "instrument.hpp"
+#include "mst.hpp"
+#include "shortestpath.hpp"
+
+namespace sdizo::async {
+
+using Clock = std::chrono::steady_clock;
+
+// Shared flag stopping every query it is given to. Cancel() is safe to call from
+// a signal handler.
+class CancellationToken {
+ public:
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+  void Reset() { cancelled_.store(false, std::memory_order_relaxed); }
+  bool Cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<bool> cancelled_{false};
+};
+
+struct Options {
+  Clock::time_point deadline{Clock::time_point::max()};
+  std::shared_ptr<const CancellationToken> token;
+};
+
+enum class Status { kRunning, kDone, kCancelled, kExpired };
+
+// Steps of a run, the settled vertices of Dijkstra and Prim, the rounds of
+// Bellman-Ford, the scanned edges of Kruskal.
+struct Progress {
+  uint64_t steps;
+  uint64_t total;  // Upper bound of the steps, 0 if unknown.
+};
+
+namespace detail {
+
+// State shared by a query handle and its run.
+struct State {
+  State(Options options, const uint64_t total, const uint64_t clock_period = 64)
+      : options(std::move(options)), total(total), clock_period(clock_period) {}
+
+  const Options options;
+  const uint64_t total;
+  // Stop() calls between the clock reads, 1 if every step is long.
+  const uint64_t clock_period;
+  std::atomic<bool> cancelled{false};
+  std::atomic<uint64_t> steps{0};
+  std::atomic<Status> status{Status::kRunning};
+};
+
+}  // namespace detail
+
+// Instrumentation policy stopping the run on the cancellation of its query or
+// on its deadline, and counting its progress. The events go to `Base`.
+template <typename Base = instrument::Disabled>
+class Cancellable : public Base {
+ public:
+  explicit Cancellable(std::shared_ptr<detail::State> state) : state_(std::move(state)) {}
+  // A run outside of any query, stopped by the token or the deadline of
+  // `options` only.
+  explicit Cancellable(Options options) : state_(std::make_shared<detail::State>(std::move(options), 0)) {}
+  // A run stopped by `token` only, which must outlive the run.
+  explicit Cancellable(const CancellationToken& token) : Cancellable(TokenOptions(token)) {}
+
+  bool Stop() {
+    if (stopped_ != Status::kRunning) return true;
+    const uint64_t steps = state_->steps.fetch_add(1, std::memory_order_relaxed);
+    const auto& token = state_->options.token;
+    if (state_->cancelled.load(std::memory_order_relaxed) || (token != nullptr && token->Cancelled()))
+      stopped_ = Status::kCancelled;
+    else if (steps % state_->clock_period == 0 && Clock::now() >= state_->options.deadline)
+      stopped_ = Status::kExpired;
+    return stopped_ != Status::kRunning;
+  }
+  // kRunning if the run was not stopped.
+  Status Stopped() const { return stopped_; }
+
+ private:
+  static Options TokenOptions(const CancellationToken& token) {
+    Options options;
+    // The caller keeps the token alive, the pointer needs no owner.
+    options.token = std::shared_ptr<const CancellationToken>(std::shared_ptr<void>(), &token);
+    return options;
+  }
+
+  std::shared_ptr<detail::State> state_;
+  Status stopped_{Status::kRunning};
+};
+
+// Handle of a query running on its own thread. Dropping the handle cancels the
+// query and waits for it to stop.
+template <typename Result>
+class Query {
+ public:
+  Query(std::shared_ptr<detail::State> state, std::future<std::unique_ptr<Result>> result)
+      : state_(std::move(state)), result_(std::move(result)) {}
+  Query(Query&&) = default;
+  Query& operator=(Query&&) = default;
+  ~Query() {
+    if (state_ != nullptr) Cancel();
+  }
+
+  void Cancel() { state_->cancelled.store(true, std::memory_order_relaxed); }
+  Status GetStatus() const { return state_->status.load(); }
+  Progress GetProgress() const { return {state_->steps.load(std::memory_order_relaxed), state_->total}; }
+
+  // Wait at most `timeout` for the query to finish, return its status.
+  template <typename Rep, typename Period>
+  Status WaitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+    result_.wait_for(timeout);
+    return GetStatus();
+  }
+  Status Wait() const {
+    result_.wait();
+    return GetStatus();
+  }
+
+  // Wait for the result, nullptr if the query was stopped or the algorithm has
+  // none (a negative cycle). Only callable once.
+  std::unique_ptr<Result> Get() { return result_.get(); }
+
+ private:
+  std::shared_ptr<detail::State> state_;
+  std::future<std::unique_ptr<Result>> result_;
+};
+
+// Run `fn`, a function of a Cancellable policy returning a unique_ptr, as a
+// query whose progress is bounded by `total` steps.
+template <typename Fn>
+auto Launch(Fn fn, const Options& options, const uint64_t total, const uint64_t clock_period = 64)
+    -> Query<typename std::invoke_result_t<Fn, Cancellable<>&>::element_type> {
+  using Result = typename std::invoke_result_t<Fn, Cancellable<>&>::element_type;
+  auto state = std::make_shared<detail::State>(options, total, clock_period);
+  auto result = std::async(std::launch::async, [state, fn = std::move(fn)]() -> std::unique_ptr<Result> {
+    Cancellable<> instr(state);
+    auto result = fn(instr);
+    const Status stopped = instr.Stopped();
+    state->status = stopped == Status::kRunning ? Status::kDone : stopped;
+    // A partial result is dropped right away.
+    if (stopped != Status::kRunning) result.reset();
+    return result;
+  });
+  return Query<Result>(std::move(state), std::move(result));
+}
+
+template <typename GRepr>
+Query<typename Graph<GRepr>::PathCost> Dijkstra(std::shared_ptr<const Graph<GRepr>> g,
+                                                const typename Graph<GRepr>::Vertex vb, const Options& options = {}) {
+  const uint64_t total = g->VerticesNo();
+  return Launch([g, vb](auto& instr) { return shortestpath::Dijkstra<GRepr>(g, vb, instr); }, options, total);
+}
+
+template <typename GRepr>
+Query<typename Graph<GRepr>::PathCost> BellmanFord(std::shared_ptr<const Graph<GRepr>> g,
+                                                   const typename Graph<GRepr>::Vertex vb,
+                                                   const Options& options = {}) {
+  const uint64_t total = g->VerticesNo();
+  // A round scans every edge, the deadline is checked after each.
+  return Launch([g, vb](auto& instr) { return shortestpath::BellmanFord<GRepr>(g, vb, instr); }, options, total, 1);
+}
+
+template <typename GRepr>
+Query<typename Graph<GRepr>::SpanningTree> Kruskal(std::shared_ptr<const Graph<GRepr>> g,
+                                                   const Options& options = {}) {
+  return Launch([g](auto& instr) { return mst::Kruskal<GRepr>(g, instr); }, options, 0);
+}
+
+template <typename GRepr>
+Query<typename Graph<GRepr>::SpanningTree> Prim(std::shared_ptr<const Graph<GRepr>> g, const Options& options = {}) {
+  const uint64_t total = g->VerticesNo();
+  return Launch([g](auto& instr) { return mst::Prim<GRepr>(g, instr); }, options, total);
+}
+
+}  // namespace sdizo::async
+
+#endif  // SDIZO_ASYNC_HPP_
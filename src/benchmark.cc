@@ -0,0 +1,310 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "args.hpp"
+#include "compressed.hpp"
+#include "concurrent.hpp"
+#include "dynamicmst.hpp"
+#include "dynamicsp.hpp"
+#include "graph.hpp"
+#include "graphgenerator.hpp"
+#include "graphreader.hpp"
+#include "graphtype.hpp"
+#include "mst.hpp"
+#include "test.hpp"
+
+namespace sdizo::test {
+namespace {
+namespace config {
+
+constexpr size_t kDensity = 50;
+constexpr size_t kRepetitions = 5;
+constexpr size_t kUpdates = 100;
+constexpr size_t kQueries = 20;  // Per reader thread.
+static constexpr std::array<size_t, 4> kVertices = {{250, 500, 1000, 2000}};
+
+}  // namespace config
+
+template <typename Fn>
+double MeasureS(Fn op) {
+  auto t1 = std::chrono::high_resolution_clock::now();
+  op();
+  auto t2 = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(t2 - t1).count();
+}
+
+// Write `edges` in the GraphReader format into a fresh temporary file and
+// return its path and size in bytes, or an empty path on failure.
+std::string WriteTemp(const std::vector<WEdge>& edges, const size_t vertices, size_t& bytes) {
+  const char* tmpdir = std::getenv("TMPDIR");
+  std::string path = std::string(tmpdir != nullptr ? tmpdir : P_tmpdir) + "/sdizograph-bench-XXXXXX";
+  const int fd = ::mkstemp(path.data());
+  if (fd < 0) return std::string();
+  FILE* fp = ::fdopen(fd, "w");
+  if (fp == nullptr) {
+    ::close(fd);
+    ::unlink(path.c_str());
+    return std::string();
+  }
+  std::fprintf(fp, "%zu %zu %zu %zu\n", edges.size(), vertices, size_t{0}, vertices - 1);
+  for (const auto& [edge, weight] : edges) std::fprintf(fp, "%zu %zu %d\n", edge.first, edge.second, weight);
+  bytes = std::ftell(fp);
+  std::fclose(fp);
+  return path;
+}
+
+// Time of parsing the whole file, in seconds.
+double MeasureParse(const char* path) {
+  return MeasureS([path] {
+    GraphReader reader;
+    size_t v, e, ub, ue;
+    Weight w;
+    if (!reader.Open(path, v, e, nullptr, nullptr)) return;
+    while (reader.ReadEdge(ub, ue, &w)) {
+    }
+  });
+}
+
+template <typename GRepr>
+double MeasureAddEdge(const std::vector<WEdge>& edges, const size_t vertices) {
+  auto g = std::make_unique<GRepr>(vertices);
+  return MeasureS([&g, &edges] {
+    for (const WEdge& edge : edges) g->AddEdge(edge);
+  });
+}
+
+template <typename GRepr>
+double MeasureAddEdges(const std::vector<WEdge>& edges, const size_t vertices, const Duplicates policy) {
+  auto g = std::make_unique<GRepr>(vertices);
+  return MeasureS([&g, &edges, policy] { g->AddEdges(edges, policy); });
+}
+
+// Time of building a sized list and of dropping it, in seconds. The storage
+// comes from a monotonic arena, released with the list, if `arena` is set, or
+// from the global heap otherwise.
+std::pair<double, double> MeasureListLifetime(const std::vector<WEdge>& edges, const size_t vertices,
+                                              const bool arena) {
+  auto resource = arena ? std::make_unique<std::pmr::monotonic_buffer_resource>() : nullptr;
+  auto g = std::make_unique<DirectedList>(vertices, arena ? resource.get() : std::pmr::new_delete_resource());
+  const double build = MeasureS([&g, &edges] {
+    for (const WEdge& edge : edges) g->AddEdge(edge);
+  });
+  const double drop = MeasureS([&g, &resource] {
+    g.reset();
+    resource.reset();
+  });
+  return {build, drop};
+}
+
+// Time of `updates` random weight changes of the edges, with the shortest paths
+// from vertex 0 repaired after each change or, if `rerun`, found anew.
+template <typename GRepr>
+double MeasureUpdates(const std::vector<WEdge>& edges, const size_t vertices, const size_t updates,
+                      const bool rerun) {
+  auto g = std::make_shared<GRepr>(vertices);
+  g->AddEdges(edges);
+  auto paths = shortestpath::DynamicShortestPath<GRepr>::Create(g, 0);
+  std::mt19937 gen;
+  std::uniform_int_distribution<size_t> edistr(0, edges.size() - 1);
+  std::uniform_int_distribution<Weight> wdistr(1, 128);
+  return MeasureS([&] {
+    for (size_t i = 0; i < updates; ++i) {
+      const auto& edge = edges[edistr(gen)].first;
+      const Weight w = wdistr(gen);
+      if (rerun) {
+        g->UpdateWeight(edge.first, edge.second, w);
+        shortestpath::Dijkstra<GRepr>(g, 0);
+      } else {
+        paths->UpdateWeight(edge.first, edge.second, w);
+      }
+    }
+  });
+}
+
+// Time of `updates` insertions of random edges into the undirected graph of
+// `edges`, with its minimum spanning tree repaired after each insertion or, if
+// `rerun`, found anew.
+double MeasureInserts(const std::vector<WEdge>& edges, const size_t vertices, const size_t updates, const bool rerun) {
+  auto g = std::make_shared<UndirectedList>(vertices);
+  g->AddEdges(edges);
+  auto tree = mst::DynamicSpanningTree<UndirectedList>::Create(vertices, *mst::Prim<UndirectedList>(g));
+  std::mt19937 gen;
+  std::uniform_int_distribution<Vertex> vdistr(0, vertices - 1);
+  std::uniform_int_distribution<Weight> wdistr(1, 128);
+  return MeasureS([&] {
+    for (size_t i = 0; i < updates; ++i) {
+      const Vertex u = vdistr(gen);
+      const Vertex v = vdistr(gen);
+      const Weight w = wdistr(gen);
+      if (rerun) {
+        g->AddEdge(u, v, w);
+        mst::Prim<UndirectedList>(g);
+      } else {
+        tree->InsertEdge(u, v, w);
+      }
+    }
+  });
+}
+
+// Time of `readers` threads running kQueries Dijkstra queries each on snapshots
+// of the graph while a writer keeps publishing versions with kUpdates more
+// random edges, in seconds, and the number of versions published meanwhile.
+std::pair<double, size_t> MeasureSnapshots(const std::vector<WEdge>& edges, const size_t vertices,
+                                           const size_t readers) {
+  auto g = std::make_unique<DirectedList>(vertices);
+  g->AddEdges(edges);
+  ConcurrentGraph<DirectedList> graph(std::move(g));
+  std::atomic<size_t> running{readers};
+  size_t versions = 0;
+  const double seconds = MeasureS([&] {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; ++t)
+      threads.emplace_back([&graph, &running, vertices, t] {
+        for (size_t i = 0; i < config::kQueries; ++i) {
+          const auto snapshot = graph.Read();
+          shortestpath::Dijkstra<DirectedList>(snapshot.Shared(), (t + i) % vertices);
+        }
+        --running;
+      });
+    std::mt19937 gen;
+    std::uniform_int_distribution<Vertex> vdistr(0, vertices - 1);
+    std::uniform_int_distribution<Weight> wdistr(1, 128);
+    std::vector<WEdge> batch(config::kUpdates);
+    while (running != 0) {
+      for (WEdge& edge : batch) edge = WEdge(Edge(vdistr(gen), vdistr(gen)), wdistr(gen));
+      graph.AddEdges(batch);
+      ++versions;
+    }
+    for (std::thread& thread : threads) thread.join();
+  });
+  return {seconds, versions};
+}
+
+}  // namespace
+
+bool Benchmark(const util::Args& args) {
+  GraphGenerator graph_gen(args.IsFlag("random"));
+  std::printf("Throughput, best of %zu repetitions, density= %zu, directed graphs\n", config::kRepetitions,
+              config::kDensity);
+  for (const size_t vertices : config::kVertices) {
+    auto edges = graph_gen.Generate(vertices, config::kDensity, true);
+    const auto undirected_edges = graph_gen.Generate(vertices, config::kDensity, false);
+    size_t bytes = 0;
+    const std::string path = WriteTemp(edges, vertices, bytes);
+    if (path.empty()) {
+      std::fprintf(stderr, "Error: Cannot create a temporary file\n");
+      return false;
+    }
+    auto g_matrix = std::make_shared<DirectedMatrix>(vertices);
+    auto g_list = std::make_shared<DirectedList>(vertices);
+    auto g_compressed = std::make_shared<DirectedCompressed>(vertices);
+    g_matrix->AddEdges(edges);
+    g_list->AddEdges(edges);
+    g_compressed->AddEdges(edges);
+
+    // Best (minimal) time of each component.
+    std::array<double, 20> best;
+    std::array<double, 6> best_updates;
+    best.fill(std::numeric_limits<double>::max());
+    best_updates.fill(std::numeric_limits<double>::max());
+    for (size_t rep = 0; rep < config::kRepetitions; ++rep) {
+      const auto [heap_build, heap_drop] = MeasureListLifetime(edges, vertices, false);
+      const auto [arena_build, arena_drop] = MeasureListLifetime(edges, vertices, true);
+      const std::array<double, 20> times = {{
+          MeasureParse(path.c_str()),
+          MeasureAddEdge<DirectedMatrix>(edges, vertices),
+          MeasureAddEdge<DirectedMatrix>(edges, 0),
+          MeasureAddEdge<DirectedList>(edges, vertices),
+          MeasureAddEdge<DirectedList>(edges, 0),
+          MeasureAddEdges<DirectedMatrix>(edges, 0, Duplicates::kKeep),
+          MeasureAddEdges<DirectedList>(edges, 0, Duplicates::kKeep),
+          MeasureAddEdges<DirectedMatrix>(edges, 0, Duplicates::kKeepMin),
+          MeasureAddEdges<DirectedList>(edges, 0, Duplicates::kKeepMin),
+          MeasureAddEdges<DirectedCompressed>(edges, 0, Duplicates::kKeep),
+          MeasureS([&g_matrix] { g_matrix->Adj(); }),
+          MeasureS([&g_list] { g_list->Adj(); }),
+          MeasureS([&g_compressed] { g_compressed->Adj(); }),
+          MeasureS([&g_matrix] { g_matrix->Edges(); }),
+          MeasureS([&g_list] { g_list->Edges(); }),
+          MeasureS([&g_compressed] { g_compressed->Edges(); }),
+          heap_build,
+          heap_drop,
+          arena_build,
+          arena_drop,
+      }};
+      for (size_t i = 0; i < best.size(); ++i) best[i] = std::min(best[i], times[i]);
+      const std::array<double, 6> update_times = {{
+          MeasureUpdates<DirectedMatrix>(edges, vertices, config::kUpdates, false),
+          MeasureUpdates<DirectedMatrix>(edges, vertices, config::kUpdates, true),
+          MeasureUpdates<DirectedList>(edges, vertices, config::kUpdates, false),
+          MeasureUpdates<DirectedList>(edges, vertices, config::kUpdates, true),
+          MeasureInserts(undirected_edges, vertices, config::kUpdates, false),
+          MeasureInserts(undirected_edges, vertices, config::kUpdates, true),
+      }};
+      for (size_t i = 0; i < best_updates.size(); ++i) best_updates[i] = std::min(best_updates[i], update_times[i]);
+    }
+    ::unlink(path.c_str());
+
+    const double medges = edges.size() / 1e6;
+    std::printf("vertices= %4zu edges= %7zu | %-24s= %9.2f MB/s\n", vertices, edges.size(), "Parse",
+                bytes / 1e6 / best[0]);
+    const char* labels[] = {
+        "AddEdge Matrix (sized)", "AddEdge Matrix (grown)", "AddEdge List (sized)",  "AddEdge List (grown)",
+        "AddEdges Matrix",        "AddEdges List",          "AddEdges Matrix (min)", "AddEdges List (min)",
+        "AddEdges Compressed",    "Adj Matrix",             "Adj List",              "Adj Compressed",
+        "Edges Matrix",           "Edges List",             "Edges Compressed",      "AddEdge List (heap)",
+        "Drop List (heap)",       "AddEdge List (arena)",   "Drop List (arena)",
+    };
+    for (size_t i = 1; i < best.size(); ++i)
+      std::printf("%29s | %-24s= %9.2f Medges/s\n", "", labels[i - 1], medges / best[i]);
+    std::printf("%29s | %-24s= %9.2f B/arc\n", "", "Size Compressed",
+                static_cast<double>(g_compressed->Bytes()) / g_compressed->ArcsNo());
+    // Weight changes with the shortest paths, and edge insertions with the
+    // minimum spanning tree of an undirected graph, kept up to date.
+    const char* update_labels[] = {
+        "Update Matrix (repair)",
+        "Update Matrix (rerun)",
+        "Update List (repair)",
+        "Update List (rerun)",
+        "Insert MST (repair)",
+        "Insert MST (rerun)",
+    };
+    for (size_t i = 0; i < best_updates.size(); ++i)
+      std::printf("%29s | %-24s= %9.2f Kupdates/s\n", "", update_labels[i], config::kUpdates / 1e3 / best_updates[i]);
+    const size_t readers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    const auto [snapshot_time, versions] = MeasureSnapshots(edges, vertices, readers);
+    std::printf("%29s | %-24s= %9.2f queries/s, %zu readers, %.2f versions/s\n", "", "Snapshot Dijkstra List",
+                readers * config::kQueries / snapshot_time, readers, versions / snapshot_time);
+  }
+  return true;
+}
+
+}  // namespace sdizo::test
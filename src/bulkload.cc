@@ -0,0 +1,34 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "bulkload.hpp"
+
+namespace sdizo::detail {
+
+bool IsThreadSafe(std::pmr::memory_resource* resource) {
+  return resource == std::pmr::new_delete_resource() ||
+         dynamic_cast<std::pmr::synchronized_pool_resource*>(resource) != nullptr;
+}
+
+#define SDIZO_INSTANTIATE_BULKLOAD(V, W)                                                                     \
+  template Buckets<V, W> Bucketize(const std::vector<std::pair<std::pair<V, V>, W>>&, size_t, bool, size_t); \
+  template bool Deduplicate(const std::pair<V, W>*, const std::pair<V, W>*, Duplicates,                      \
+                            std::vector<std::pair<V, W>>&);                                                  \
+  template size_t VertexBound(const std::vector<std::pair<std::pair<V, V>, W>>&);
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_INSTANTIATE_BULKLOAD)
+#undef SDIZO_INSTANTIATE_BULKLOAD
+
+}  // namespace sdizo::detail
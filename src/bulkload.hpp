@@ -0,0 +1,146 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_BULKLOAD_HPP_
+#define SDIZO_BULKLOAD_HPP_
+
+#include <algorithm>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "graphtype.hpp"
+#include "parallel.hpp"
+
+namespace sdizo {
+
+// What AddEdges does with parallel edges, the ones with the same endpoints (in
+// any order for undirected graphs), within the batch or already in the graph.
+enum class Duplicates {
+  kKeep,      // Behave like repeated AddEdge calls.
+  kKeepMin,   // Keep the lowest weight.
+  kKeepLast,  // Keep the weight which comes last.
+  kReject,    // Add nothing if there is any.
+};
+
+namespace detail {
+
+// Batch of edges bucketed by the source vertex with a stable counting sort,
+// arcs[offsets[u]..offsets[u + 1]) are the arcs leaving u in the batch order.
+// Undirected edges are stored in both directions, self-loops once.
+template <typename V, typename W>
+struct Buckets {
+  using Connection = std::pair<V, W>;
+
+  std::vector<size_t> offsets;
+  std::vector<Connection> arcs;
+
+  const Connection* begin(const V u) const { return arcs.data() + offsets[u]; }
+  const Connection* end(const V u) const { return arcs.data() + offsets[u + 1]; }
+};
+
+template <typename V, typename W>
+Buckets<V, W> Bucketize(const std::vector<std::pair<std::pair<V, V>, W>>& edges, const size_t vertex_no,
+                        const bool is_directed, const size_t threads) {
+  using Connection = std::pair<V, W>;
+  const size_t chunks = std::max<size_t>(1, std::min(threads, edges.size()));
+  const auto for_arcs = [is_directed](const std::pair<std::pair<V, V>, W>& wedge, auto fn) {
+    const auto& [edge, weight] = wedge;
+    fn(edge.first, Connection(edge.second, weight));
+    if (!is_directed && edge.first != edge.second) fn(edge.second, Connection(edge.first, weight));
+  };
+  // Number of arcs leaving each vertex in each chunk of the batch, then the
+  // position of the next such arc.
+  std::vector<std::vector<size_t>> counts(chunks, std::vector<size_t>(vertex_no));
+  parallel::For(chunks, edges.size(), [&](const size_t chunk, const size_t begin, const size_t end) {
+    auto& count = counts[chunk];
+    for (size_t i = begin; i < end; ++i) for_arcs(edges[i], [&count](const V u, const Connection&) { ++count[u]; });
+  });
+  Buckets<V, W> buckets;
+  buckets.offsets.resize(vertex_no + 1);
+  size_t total = 0;
+  for (size_t u = 0; u < vertex_no; ++u) {
+    buckets.offsets[u] = total;
+    for (auto& count : counts) {
+      const size_t n = count[u];
+      count[u] = total;
+      total += n;
+    }
+  }
+  buckets.offsets[vertex_no] = total;
+  buckets.arcs.resize(total);
+  parallel::For(chunks, edges.size(), [&](const size_t chunk, const size_t begin, const size_t end) {
+    auto& position = counts[chunk];
+    for (size_t i = begin; i < end; ++i)
+      for_arcs(edges[i], [&](const V u, const Connection& arc) { buckets.arcs[position[u]++] = arc; });
+  });
+  return buckets;
+}
+
+// Reduce the arcs of a single bucket according to `policy` into `out`, sorted by
+// the target vertex unless the policy is Duplicates::kKeep. Return false, if the
+// policy is Duplicates::kReject and there are any duplicates.
+template <typename V, typename W>
+bool Deduplicate(const std::pair<V, W>* first, const std::pair<V, W>* last, const Duplicates policy,
+                 std::vector<std::pair<V, W>>& out) {
+  using Connection = std::pair<V, W>;
+  out.assign(first, last);
+  if (policy == Duplicates::kKeep) return true;
+  std::stable_sort(out.begin(), out.end(), [](const Connection& lhs, const Connection& rhs) -> bool {
+    return lhs.first < rhs.first;
+  });
+  auto kept = out.begin();
+  for (auto it = out.begin(); it != out.end();) {
+    auto group_end = std::find_if(it, out.end(), [it](const Connection& arc) { return arc.first != it->first; });
+    if (policy == Duplicates::kReject && group_end - it > 1) return false;
+    const Connection arc =
+        policy == Duplicates::kKeepMin
+            ? *std::min_element(it, group_end, [](const Connection& lhs, const Connection& rhs) -> bool {
+                return lhs.second < rhs.second;
+              })
+            : *(group_end - 1);
+    *kept++ = arc;
+    it = group_end;
+  }
+  out.erase(kept, out.end());
+  return true;
+}
+
+// The largest vertex of `edges` plus one, or 0 for no edges.
+template <typename V, typename W>
+size_t VertexBound(const std::vector<std::pair<std::pair<V, V>, W>>& edges) {
+  size_t bound = 0;
+  for (const auto& [edge, weight] : edges)
+    bound = std::max({bound, static_cast<size_t>(edge.first) + 1, static_cast<size_t>(edge.second) + 1});
+  return bound;
+}
+
+// Whether allocations from `resource` may happen concurrently.
+bool IsThreadSafe(std::pmr::memory_resource* resource);
+
+#define SDIZO_EXTERN_BULKLOAD(V, W)                                                                                 \
+  extern template Buckets<V, W> Bucketize(const std::vector<std::pair<std::pair<V, V>, W>>&, size_t, bool, size_t); \
+  extern template bool Deduplicate(const std::pair<V, W>*, const std::pair<V, W>*, Duplicates,                      \
+                                   std::vector<std::pair<V, W>>&);                                                  \
+  extern template size_t VertexBound(const std::vector<std::pair<std::pair<V, V>, W>>&);
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_EXTERN_BULKLOAD)
+#undef SDIZO_EXTERN_BULKLOAD
+
+}  // namespace detail
+
+}  // namespace sdizo
+
+#endif  // SDIZO_BULKLOAD_HPP_
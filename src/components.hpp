@@ -0,0 +1,140 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_COMPONENTS_HPP_
+#define SDIZO_COMPONENTS_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "graph.hpp"
+#include "parallel.hpp"
+
+namespace sdizo::components {
+
+// Connected components of a graph, weakly connected of a directed one.
+template <typename GRepr>
+struct Components {
+  using Vertex = typename Graph<GRepr>::Vertex;
+
+  explicit Components(std::pmr::memory_resource* resource) : ids(resource) {}
+
+  // Component of every vertex, the smallest vertex in it.
+  std::pmr::vector<Vertex> ids;
+  size_t count{0};
+};
+
+namespace detail {
+
+// Union of the trees of `u` and `v` in the forest of `parents`, hooking the
+// larger root under the smaller one with a CAS, so that concurrent links never
+// form a cycle and every root is the smallest vertex of its tree.
+template <typename Vertex>
+void Link(Vertex u, Vertex v, std::vector<std::atomic<Vertex>>& parents) {
+  Vertex pu = parents[u].load(std::memory_order_relaxed);
+  Vertex pv = parents[v].load(std::memory_order_relaxed);
+  while (pu != pv) {
+    const Vertex high = std::max(pu, pv);
+    const Vertex low = std::min(pu, pv);
+    Vertex p_high = parents[high].load(std::memory_order_relaxed);
+    if (p_high == low) break;
+    if (p_high == high && parents[high].compare_exchange_strong(p_high, low, std::memory_order_relaxed)) break;
+    pu = parents[parents[high].load(std::memory_order_relaxed)].load(std::memory_order_relaxed);
+    pv = parents[low].load(std::memory_order_relaxed);
+  }
+}
+
+// Point the vertices of [begin, end) straight at their root.
+template <typename Vertex>
+void Compress(const size_t begin, const size_t end, std::vector<std::atomic<Vertex>>& parents) {
+  for (size_t v = begin; v < end; ++v) {
+    Vertex p = parents[v].load(std::memory_order_relaxed);
+    while (p != parents[p].load(std::memory_order_relaxed)) p = parents[p].load(std::memory_order_relaxed);
+    parents[v].store(p, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace detail
+
+// Connected components by parallel label propagation in the style of Afforest:
+// the trees of the endpoints of every edge are linked with Shiloach-Vishkin
+// hooking. In an undirected graph the first `kSampleEdges` edges of each vertex
+// are linked first, which usually reveals the giant component, and its vertices
+// skip the rest of their edges, the other endpoints of those joining it through
+// their own.
+template <typename GRepr>
+std::unique_ptr<Components<GRepr>> ConnectedComponents(
+    std::shared_ptr<const Graph<GRepr>> g, const size_t threads = 1,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Weight = typename Graph<GRepr>::Weight;
+  constexpr size_t kSampleEdges = 2;
+  // Vertices whose labels are counted to find the giant component.
+  constexpr size_t kSampleVertices = 1024;
+  const size_t vertex_no = g->VerticesNo();
+  std::vector<std::atomic<Vertex>> parents(vertex_no);
+  parallel::For(threads, vertex_no, [&parents](size_t, const size_t begin, const size_t end) {
+    for (size_t v = begin; v < end; ++v) parents[v].store(static_cast<Vertex>(v), std::memory_order_relaxed);
+  });
+  // Link the edges of every vertex from the `first` on, but the vertices of the
+  // `skip` component, up to `last` edges, leaving the walk there.
+  const auto link = [&](const size_t first, const size_t last, const Vertex skip) {
+    parallel::For(threads, vertex_no, [&](size_t, const size_t begin, const size_t end) {
+      for (size_t u = begin; u < end; ++u) {
+        if (parents[u].load(std::memory_order_relaxed) == skip) continue;
+        size_t i = 0;
+        g->ForEachNeighbourWhile(static_cast<Vertex>(u), [&](const Vertex v, Weight) {
+          if (i >= first) detail::Link(static_cast<Vertex>(u), v, parents);
+          return ++i < last;
+        });
+      }
+    });
+    parallel::For(threads, vertex_no,
+                  [&parents](size_t, const size_t begin, const size_t end) { detail::Compress(begin, end, parents); });
+  };
+  // A vertex is never its own parent's skip label: vertex_no is out of range.
+  Vertex giant = static_cast<Vertex>(vertex_no);
+  if constexpr (!GRepr::kIsDirected) {
+    link(0, kSampleEdges, giant);
+    std::unordered_map<Vertex, size_t> counts;
+    const size_t step = std::max<size_t>(1, vertex_no / kSampleVertices);
+    for (size_t v = 0; v < vertex_no; v += step) ++counts[parents[v].load(std::memory_order_relaxed)];
+    if (!counts.empty())
+      giant = std::max_element(counts.cbegin(), counts.cend(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second < rhs.second;
+              })->first;
+    link(kSampleEdges, SIZE_MAX, giant);
+  } else {
+    link(0, SIZE_MAX, giant);
+  }
+  auto components = std::make_unique<Components<GRepr>>(resource);
+  components->ids.resize(vertex_no);
+  for (size_t v = 0; v < vertex_no; ++v) {
+    components->ids[v] = parents[v].load(std::memory_order_relaxed);
+    components->count += components->ids[v] == v;
+  }
+  return components;
+}
+
+}  // namespace sdizo::components
+
+#endif  // SDIZO_COMPONENTS_HPP_
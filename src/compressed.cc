@@ -0,0 +1,27 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "compressed.hpp"
+
+namespace sdizo {
+
+#define SDIZO_INSTANTIATE_COMPRESSED(V, W)    \
+  template class CompressedGraph<true, V, W>; \
+  template class CompressedGraph<false, V, W>;
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_INSTANTIATE_COMPRESSED)
+#undef SDIZO_INSTANTIATE_COMPRESSED
+
+}  // namespace sdizo
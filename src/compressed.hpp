@@ -0,0 +1,326 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_COMPRESSED_HPP_
+#define SDIZO_COMPRESSED_HPP_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <set>
+#include <vector>
+
+#include "bulkload.hpp"
+#include "graph.hpp"
+#include "graphtype.hpp"
+#include "output.hpp"
+
+namespace sdizo {
+
+namespace detail {
+
+// LEB128 varint, 7 bits per byte with the high bit set on all but the last.
+inline void WriteVarint(uint64_t value, std::pmr::vector<uint8_t>& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+inline uint64_t ReadVarint(const uint8_t*& p) {
+  uint64_t value = *p & 0x7f;
+  for (unsigned shift = 7; *p++ & 0x80; shift += 7) value |= static_cast<uint64_t>(*p & 0x7f) << shift;
+  return value;
+}
+
+// Sequence of `width`-bit values packed from the least significant bit of the
+// first byte.
+class BitWriter {
+ public:
+  BitWriter(const unsigned width, std::pmr::vector<uint8_t>& out) : width_(width), out_(out) {}
+  ~BitWriter() {
+    if (bits_ != 0) out_.push_back(static_cast<uint8_t>(acc_));
+  }
+
+  void Write(uint64_t value) {
+    for (unsigned left = width_; left != 0;) {
+      const unsigned take = std::min(left, 8 - bits_);
+      acc_ |= (value & ((uint64_t{1} << take) - 1)) << bits_;
+      value >>= take;
+      left -= take;
+      bits_ += take;
+      if (bits_ == 8) {
+        out_.push_back(static_cast<uint8_t>(acc_));
+        acc_ = 0;
+        bits_ = 0;
+      }
+    }
+  }
+
+ private:
+  const unsigned width_;
+  std::pmr::vector<uint8_t>& out_;
+  uint64_t acc_{0};
+  unsigned bits_{0};
+};
+// Reads the values of a BitWriter with unaligned 64-bit loads, so the buffer
+// must be followed by kBitReaderPadding readable bytes.
+constexpr size_t kBitReaderPadding = 9;
+class BitReader {
+ public:
+  BitReader(const unsigned width, const uint8_t* p)
+      : width_(width), mask_(width < 64 ? (uint64_t{1} << width) - 1 : ~uint64_t{0}), p_(p) {}
+
+  uint64_t Read() {
+    const uint8_t* const p = p_ + (bit_ >> 3);
+    const unsigned shift = bit_ & 7;
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    uint64_t value = word >> shift;
+    // A value wider than 56 bits may span a ninth byte.
+    if (width_ > 56 && shift != 0) value |= static_cast<uint64_t>(p[8]) << (64 - shift);
+    bit_ += width_;
+    return value & mask_;
+  }
+
+ private:
+  const unsigned width_;
+  const uint64_t mask_;
+  const uint8_t* p_;
+  size_t bit_{0};
+};
+
+}  // namespace detail
+
+template <bool kDirected, typename V = Vertex, typename W = Weight>
+class CompressedGraph;
+
+template <bool kDirected, typename V, typename W>
+struct GraphTraits<CompressedGraph<kDirected, V, W>> : GraphTypes<V, W> {};
+
+// Read-mostly graph storing the arcs leaving each vertex, sorted by the target,
+// as a compressed block of bytes:
+//   [count varint][count weights of weight_bits_ bits][count target gap varints]
+// where a weight is stored as its difference from the lowest weight of the graph
+// and a gap is the difference from the previous target (the first from 0). A
+// vertex without arcs has an empty block. Neighbours are decoded on the fly by
+// ForEachNeighbour, Adj() materializes an uncompressed copy. Undirected edges
+// are stored in both directions, self-loops once. A few bytes of padding follow
+// the last block.
+//
+// Every change re-encodes the whole graph, so build it with a single AddEdges.
+template <bool kDirected, typename V, typename W>
+class CompressedGraph : public Graph<CompressedGraph<kDirected, V, W>> {
+ public:
+  static constexpr bool kIsDirected = kDirected;
+  using Vertex = V;
+  using Weight = W;
+  using Edge = typename GraphTypes<V, W>::Edge;
+  using WEdge = typename GraphTypes<V, W>::WEdge;
+  using EdgeArrays = typename GraphTypes<V, W>::EdgeArrays;
+  using Connection = typename GraphTypes<V, W>::Connection;
+  using Connections = typename GraphTypes<V, W>::Connections;
+  using Adjacent = typename GraphTypes<V, W>::Adjacent;
+
+  explicit CompressedGraph(const size_t vertices = 0,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : offsets_(vertices + 1, 0, resource), bytes_(resource) {}
+
+  std::shared_ptr<const Adjacent> Adj() const {
+    auto adjacent = std::make_shared<Adjacent>(VerticesNo(), Resource());
+    for (size_t u = 0; u < VerticesNo(); ++u)
+      ForEachNeighbour(u, [&](const Vertex v, const Weight w) { (*adjacent)[u].emplace_back(v, w); });
+    return adjacent;
+  }
+  template <typename Fn>
+  void ForEachNeighbour(const Vertex u, Fn fn) const {
+    ForEachNeighbourWhile(u, [&fn](const Vertex v, const Weight w) {
+      fn(v, w);
+      return true;
+    });
+  }
+  template <typename Fn>
+  void ForEachNeighbourWhile(const Vertex u, Fn fn) const {
+    const uint8_t* p = bytes_.data() + offsets_[u];
+    if (p == bytes_.data() + offsets_[u + 1]) return;
+    const uint64_t count = detail::ReadVarint(p);
+    detail::BitReader weights(weight_bits_, p);
+    p += (count * weight_bits_ + 7) / 8;
+    uint64_t v = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+      v += detail::ReadVarint(p);
+      const Weight weight = static_cast<Weight>(static_cast<uint64_t>(weight_base_) + weights.Read());
+      if (!fn(static_cast<Vertex>(v), weight)) return;
+    }
+  }
+  // Every edge once, an undirected one as (u, v) with u <= v.
+  std::unique_ptr<std::vector<WEdge>> Edges() const {
+    auto edges = std::make_unique<std::vector<WEdge>>();
+    edges->reserve(kDirected ? arcs_ : arcs_ / 2 + 1);
+    for (size_t u = 0; u < VerticesNo(); ++u)
+      ForEachNeighbour(u, [&](const Vertex v, const Weight w) {
+        if (kDirected || u <= v) edges->emplace_back(Edge(u, v), w);
+      });
+    return edges;
+  }
+  std::unique_ptr<EdgeArrays> EdgesByTarget() const {
+    const size_t n = VerticesNo();
+    auto arcs = std::make_unique<EdgeArrays>(Resource());
+    arcs->offsets.assign(n + 1, 0);
+    for (size_t u = 0; u < n; ++u) ForEachNeighbour(u, [&](const Vertex v, Weight) { ++arcs->offsets[v + 1]; });
+    std::partial_sum(arcs->offsets.cbegin(), arcs->offsets.cend(), arcs->offsets.begin());
+    arcs->src.resize(arcs_);
+    arcs->dst.resize(arcs_);
+    arcs->w.resize(arcs_);
+    std::vector<size_t> next(arcs->offsets.cbegin(), arcs->offsets.cend() - 1);
+    for (size_t u = 0; u < n; ++u)
+      ForEachNeighbour(u, [&](const Vertex v, const Weight w) {
+        const size_t k = next[v]++;
+        arcs->src[k] = u;
+        arcs->dst[k] = v;
+        arcs->w[k] = w;
+      });
+    return arcs;
+  }
+  void Print() const {
+    output::Writer out;
+    for (size_t u = 0; u < VerticesNo(); ++u) {
+      if (offsets_[u] == offsets_[u + 1]) continue;
+      out.Number(u).Char(':');
+      const char* separator = " (";
+      ForEachNeighbour(u, [&out, &separator](const Vertex v, const Weight w) {
+        out.Text(separator).Number(static_cast<size_t>(v)).Text(", ").Number(static_cast<int64_t>(w)).Char(')');
+        separator = ", (";
+      });
+      out.Char('\n');
+    }
+  }
+  std::unique_ptr<std::set<Vertex>> Vertices() const {
+    auto vertices = std::make_unique<std::set<Vertex>>();
+    for (size_t v = 0; v < VerticesNo(); ++v) vertices->insert(vertices->cend(), v);
+    return vertices;
+  }
+  size_t VerticesNo() const { return offsets_.size() - 1; }
+  std::pmr::memory_resource* Resource() const { return bytes_.get_allocator().resource(); }
+  // Number of stored arcs, an undirected edge counts twice, a self-loop once.
+  size_t ArcsNo() const { return arcs_; }
+  // Size of the encoded arcs and their offsets.
+  size_t Bytes() const { return bytes_.size() + offsets_.size() * sizeof(offsets_[0]); }
+
+  void AddEdge(const WEdge& edge) { AddEdge(edge.first.first, edge.first.second, edge.second); }
+  void AddEdge(const Vertex vb, const Vertex ve, const Weight w) { AddEdges({WEdge(Edge(vb, ve), w)}); }
+  // Re-encode the graph with the batch of edges, see Duplicates. Return false,
+  // leaving the graph unchanged, if the policy is Duplicates::kReject and an
+  // edge is repeated or already exists.
+  bool AddEdges(const std::vector<WEdge>& edges, const Duplicates policy = Duplicates::kKeep, size_t threads = 1) {
+    if (!detail::IsThreadSafe(Resource())) threads = 1;
+    const size_t vertex_no = std::max(VerticesNo(), detail::VertexBound(edges));
+    if (policy == Duplicates::kReject) {
+      const detail::Buckets<V, W> buckets = detail::Bucketize(edges, vertex_no, kDirected, threads);
+      std::vector<Connection> unique;
+      std::vector<Vertex> targets;
+      for (Vertex u = 0; u < vertex_no; ++u) {
+        if (!detail::Deduplicate(buckets.begin(u), buckets.end(u), policy, unique)) return false;
+        if (unique.empty() || u >= VerticesNo()) continue;
+        targets.clear();
+        ForEachNeighbour(u, [&targets](const Vertex v, Weight) { targets.push_back(v); });
+        for (const auto& [v, weight] : unique)
+          if (std::binary_search(targets.cbegin(), targets.cend(), v)) return false;
+      }
+    }
+    // The existing edges go first, so that Duplicates::kKeepLast prefers the
+    // batch.
+    auto all = Edges();
+    all->insert(all->end(), edges.cbegin(), edges.cend());
+    const detail::Buckets<V, W> buckets = detail::Bucketize(*all, vertex_no, kDirected, threads);
+    all.reset();
+    const Duplicates merge = policy == Duplicates::kReject ? Duplicates::kKeep : policy;
+    W lowest = 0, highest = 0;
+    if (!buckets.arcs.empty()) {
+      const auto [min, max] = std::minmax_element(
+          buckets.arcs.cbegin(), buckets.arcs.cend(),
+          [](const Connection& lhs, const Connection& rhs) -> bool { return lhs.second < rhs.second; });
+      lowest = min->second;
+      highest = max->second;
+    }
+    const uint64_t range = static_cast<uint64_t>(highest) - static_cast<uint64_t>(lowest);
+    unsigned weight_bits = 0;
+    while (weight_bits < 64 && range >> weight_bits != 0) ++weight_bits;
+    std::pmr::vector<uint64_t> offsets(vertex_no + 1, 0, Resource());
+    std::pmr::vector<uint8_t> bytes(Resource());
+    size_t arcs = 0;
+    std::vector<Connection> unique;
+    for (Vertex u = 0; u < vertex_no; ++u) {
+      offsets[u] = bytes.size();
+      detail::Deduplicate(buckets.begin(u), buckets.end(u), merge, unique);
+      if (unique.empty()) continue;
+      if (merge == Duplicates::kKeep)
+        std::stable_sort(unique.begin(), unique.end(), [](const Connection& lhs, const Connection& rhs) -> bool {
+          return lhs.first < rhs.first;
+        });
+      arcs += unique.size();
+      detail::WriteVarint(unique.size(), bytes);
+      {
+        detail::BitWriter weights(weight_bits, bytes);
+        for (const auto& [v, w] : unique) weights.Write(static_cast<uint64_t>(w) - static_cast<uint64_t>(lowest));
+      }
+      Vertex previous = 0;
+      for (const auto& [v, w] : unique) {
+        detail::WriteVarint(v - previous, bytes);
+        previous = v;
+      }
+    }
+    offsets[vertex_no] = bytes.size();
+    bytes.resize(bytes.size() + detail::kBitReaderPadding, 0);
+    bytes.shrink_to_fit();
+    offsets_ = std::move(offsets);
+    bytes_ = std::move(bytes);
+    arcs_ = arcs;
+    weight_base_ = lowest;
+    weight_bits_ = weight_bits;
+    return true;
+  }
+
+ private:
+  // Block of the arcs leaving u, bytes_[offsets_[u]..offsets_[u + 1]).
+  std::pmr::vector<uint64_t> offsets_;
+  std::pmr::vector<uint8_t> bytes_;
+  size_t arcs_{0};
+  W weight_base_{0};
+  unsigned weight_bits_{0};
+};
+
+#define SDIZO_EXTERN_COMPRESSED(V, W)                \
+  extern template class CompressedGraph<true, V, W>; \
+  extern template class CompressedGraph<false, V, W>;
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_EXTERN_COMPRESSED)
+#undef SDIZO_EXTERN_COMPRESSED
+
+using DirectedCompressed = CompressedGraph<true>;
+using UndirectedCompressed = CompressedGraph<false>;
+
+}  // namespace sdizo
+
+#endif  // SDIZO_COMPRESSED_HPP_
@@ -0,0 +1,169 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_CONCURRENT_HPP_
+#define SDIZO_CONCURRENT_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bulkload.hpp"
+#include "graph.hpp"
+
+namespace sdizo {
+
+// Graph shared by one or more writers and any number of readers. Every version
+// of the graph is immutable once published: a writer copies the current
+// version, applies a batch of changes to the copy and publishes it with a single
+// atomic store. Readers take a Snapshot, which pins the version current at that
+// moment without locks or reference counting, and see no change while they hold
+// it. A replaced version is retired with the epoch of its replacement and
+// reclaimed once every reader pinned before that epoch has let go.
+template <typename GRepr>
+class ConcurrentGraph {
+  static constexpr size_t kSlots = 128;
+  static constexpr uint64_t kIdle = std::numeric_limits<uint64_t>::max();
+
+  // Epoch announced by an active reader, kIdle if the slot is free.
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{kIdle};
+  };
+  struct Version {
+    std::unique_ptr<const GRepr> g;
+    uint64_t number;  // Number of the versions published before.
+  };
+
+ public:
+  using WEdge = typename Graph<GRepr>::WEdge;
+
+  // Read-only view of one version, valid for the lifetime of the snapshot. A
+  // snapshot must not outlive its ConcurrentGraph.
+  class Snapshot {
+   public:
+    Snapshot(Snapshot&& other) noexcept : slot_(std::exchange(other.slot_, nullptr)), version_(other.version_) {}
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    Snapshot& operator=(Snapshot&&) = delete;
+    ~Snapshot() {
+      if (slot_ != nullptr) slot_->epoch.store(kIdle, std::memory_order_release);
+    }
+
+    const GRepr& operator*() const { return *version_->g; }
+    const GRepr* operator->() const { return version_->g.get(); }
+    // Non-owning pointer for the algorithms taking a shared graph.
+    std::shared_ptr<const Graph<GRepr>> Shared() const {
+      return std::shared_ptr<const Graph<GRepr>>(std::shared_ptr<void>(), version_->g.get());
+    }
+    // Number of the versions published before this one.
+    uint64_t Number() const { return version_->number; }
+
+   private:
+    friend class ConcurrentGraph;
+    Snapshot(Slot* slot, const Version* version) : slot_(slot), version_(version) {}
+
+    Slot* slot_;
+    const Version* version_;
+  };
+
+  explicit ConcurrentGraph(std::unique_ptr<GRepr> g) : current_(new Version{std::move(g), 0}) {}
+  ConcurrentGraph(const ConcurrentGraph&) = delete;
+  ConcurrentGraph& operator=(const ConcurrentGraph&) = delete;
+  // No snapshot may be alive.
+  ~ConcurrentGraph() {
+    delete current_.load();
+    for (auto& [epoch, version] : retired_) delete version;
+  }
+
+  // Pin the current version. Only waits if all the reader slots are taken.
+  Snapshot Read() const {
+    while (true) {
+      for (Slot& slot : slots_) {
+        // The epoch is announced before the version is loaded, so a writer which
+        // misses the announcement has already published the next version.
+        uint64_t idle = kIdle;
+        if (!slot.epoch.compare_exchange_strong(idle, epoch_.load())) continue;
+        return Snapshot(&slot, current_.load());
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  // Apply `update`, a function of GRepr&, to a copy of the current version and
+  // publish the copy. Concurrent writers are serialized. Batch the changes into
+  // few calls, each one copies the whole graph.
+  template <typename Fn>
+  void Update(Fn update) {
+    std::lock_guard<std::mutex> lock(writer_);
+    auto next = std::make_unique<GRepr>(*current_.load()->g);
+    update(*next);
+    Publish(std::move(next));
+  }
+
+  // Publish a version with the `edges` added, return false, publishing nothing,
+  // if they are rejected by `policy`.
+  bool AddEdges(const std::vector<WEdge>& edges, const Duplicates policy = Duplicates::kKeep) {
+    std::lock_guard<std::mutex> lock(writer_);
+    auto next = std::make_unique<GRepr>(*current_.load()->g);
+    if (!next->AddEdges(edges, policy)) return false;
+    Publish(std::move(next));
+    return true;
+  }
+
+  // Free the retired versions no reader can hold any more, return how many are
+  // still waiting.
+  size_t Reclaim() {
+    std::lock_guard<std::mutex> lock(writer_);
+    ReclaimLocked();
+    return retired_.size();
+  }
+
+ private:
+  void Publish(std::unique_ptr<GRepr> g) {
+    const Version* previous = current_.load();
+    current_.store(new Version{std::move(g), previous->number + 1});
+    retired_.emplace_back(epoch_.fetch_add(1), previous);
+    ReclaimLocked();
+  }
+
+  void ReclaimLocked() {
+    uint64_t oldest = kIdle;
+    for (const Slot& slot : slots_) oldest = std::min(oldest, slot.epoch.load());
+    // A version retired at epoch e may be held by the readers announced at e or
+    // earlier.
+    const auto reclaimable = std::partition(retired_.begin(), retired_.end(),
+                                            [oldest](const auto& retired) { return retired.first >= oldest; });
+    for (auto it = reclaimable; it != retired_.end(); ++it) delete it->second;
+    retired_.erase(reclaimable, retired_.end());
+  }
+
+  std::atomic<const Version*> current_;
+  std::atomic<uint64_t> epoch_{0};
+  mutable std::array<Slot, kSlots> slots_;
+  std::mutex writer_;
+  std::vector<std::pair<uint64_t, const Version*>> retired_;  // (epoch, version)
+};
+
+}  // namespace sdizo
+
+#endif  // SDIZO_CONCURRENT_HPP_
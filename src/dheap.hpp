@@ -0,0 +1,180 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_DHEAP_HPP_
+#define SDIZO_DHEAP_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace sdizo {
+
+// Min-priority queue of (id, key) entries with lazy insertion: a lower key of an
+// id already queued is pushed as another entry, the outdated one is popped later
+// and has to be skipped by the caller. The queue grows up to the number of pushes.
+template <typename Key, typename Id>
+class LazyQueue {
+ public:
+  explicit LazyQueue(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : heap_(resource) {}
+
+  // Prepare the queue for the ids in [0, n).
+  void Resize(size_t) {}
+
+  bool Empty() const { return heap_.empty(); }
+  size_t Size() const { return heap_.size(); }
+
+  // Queue `id` with `key`. Return true, as a new entry is always added.
+  bool Push(const Id id, const Key key) {
+    heap_.push_back({key, id});
+    std::push_heap(heap_.begin(), heap_.end(), Greater{});
+    return true;
+  }
+
+  // Remove and return the entry of the lowest key.
+  std::pair<Id, Key> Pop() {
+    std::pop_heap(heap_.begin(), heap_.end(), Greater{});
+    const Entry entry = heap_.back();
+    heap_.pop_back();
+    return {entry.id, entry.key};
+  }
+
+  void Clear() { heap_.clear(); }
+
+ private:
+  struct Entry {
+    Key key;
+    Id id;
+  };
+  struct Greater {
+    bool operator()(const Entry& lhs, const Entry& rhs) const { return lhs.key > rhs.key; }
+  };
+
+  std::pmr::vector<Entry> heap_;
+};
+
+// Indexed d-ary min-heap of (id, key) entries with ids in [0, n). A position map
+// keeps at most one entry per id, so a lower key of a queued id is a decrease-key
+// in place and the heap never holds more than n entries. A wider node makes the
+// tree shallower, decrease-key cheaper and pop compare more children at once.
+template <typename Key, typename Id, size_t kArity = 4>
+class IndexedDHeap {
+  static_assert(kArity >= 2);
+
+ public:
+  explicit IndexedDHeap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : heap_(resource), positions_(resource) {}
+
+  // Prepare the heap for the ids in [0, n).
+  void Resize(const size_t n) {
+    heap_.reserve(n);
+    positions_.resize(n, kAbsent);
+  }
+
+  bool Empty() const { return heap_.empty(); }
+  size_t Size() const { return heap_.size(); }
+  bool Contains(const Id id) const { return positions_[id] != kAbsent; }
+
+  // Queue `id` with `key`, or lower its key if it is already queued with a
+  // higher one. Return true if a new entry was added.
+  bool Push(const Id id, const Key key) {
+    const Id position = positions_[id];
+    if (position == kAbsent) {
+      heap_.push_back({key, id});
+      SiftUp(heap_.size() - 1);
+      return true;
+    }
+    if (key < heap_[position].key) {
+      heap_[position].key = key;
+      SiftUp(position);
+    }
+    return false;
+  }
+
+  // Remove and return the entry of the lowest key.
+  std::pair<Id, Key> Pop() {
+    const Entry top = heap_.front();
+    positions_[top.id] = kAbsent;
+    const Entry last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+      heap_.front() = last;
+      SiftDown(0);
+    }
+    return {top.id, top.key};
+  }
+
+  // Empty the heap in O(size), the position map stays allocated.
+  void Clear() {
+    for (const Entry& entry : heap_) positions_[entry.id] = kAbsent;
+    heap_.clear();
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    Id id;
+  };
+
+  static constexpr Id kAbsent = std::numeric_limits<Id>::max();
+
+  void Place(const size_t i, const Entry& entry) {
+    heap_[i] = entry;
+    positions_[entry.id] = static_cast<Id>(i);
+  }
+
+  void SiftUp(size_t i) {
+    const Entry entry = heap_[i];
+    while (i > 0) {
+      const size_t parent = (i - 1) / kArity;
+      if (!(entry.key < heap_[parent].key)) break;
+      Place(i, heap_[parent]);
+      i = parent;
+    }
+    Place(i, entry);
+  }
+
+  void SiftDown(size_t i) {
+    const Entry entry = heap_[i];
+    const size_t size = heap_.size();
+    while (true) {
+      const size_t first = i * kArity + 1;
+      if (first >= size) break;
+      const size_t last = std::min(first + kArity, size);
+      size_t best = first;
+      for (size_t child = first + 1; child < last; ++child)
+        if (heap_[child].key < heap_[best].key) best = child;
+      if (!(heap_[best].key < entry.key)) break;
+      Place(i, heap_[best]);
+      i = best;
+    }
+    Place(i, entry);
+  }
+
+  std::pmr::vector<Entry> heap_;
+  std::pmr::vector<Id> positions_;
+};
+
+// IndexedDHeap of the default arity, as a queue policy of the graph algorithms.
+template <typename Key, typename Id>
+using IndexedQueue = IndexedDHeap<Key, Id>;
+
+}  // namespace sdizo
+
+#endif  // SDIZO_DHEAP_HPP_
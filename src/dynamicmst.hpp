@@ -0,0 +1,282 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_DYNAMICMST_HPP_
+#define SDIZO_DYNAMICMST_HPP_
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "graph.hpp"
+#include "instrument.hpp"
+
+namespace sdizo::mst {
+
+// Minimum spanning tree, or forest, kept up to date under edge insertions and
+// weight decreases. The tree is stored as a link-cut tree in which every tree
+// edge is a node of its own between its two endpoints, so the heaviest edge on
+// the tree path between two vertices is found in amortized O(log V). A new edge
+// (u, v) replaces the heaviest edge on the path u..v if it is lighter, or links
+// two trees of the forest. The edges which do not enter the tree are not kept,
+// insertions and decreases never make them needed again.
+template <typename GRepr, typename Instr = instrument::Disabled>
+class DynamicSpanningTree {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Weight = typename Graph<GRepr>::Weight;
+  using Edge = typename Graph<GRepr>::Edge;
+  using WEdge = typename Graph<GRepr>::WEdge;
+  using SpanningTree = typename Graph<GRepr>::SpanningTree;
+  using Cost = typename Graph<GRepr>::Distance;
+  static constexpr size_t kNil = std::numeric_limits<size_t>::max();
+
+ public:
+  // Seed the structure with `tree` over `vertex_no` vertices. Return nullptr if
+  // an edge has a vertex out of range or closes a cycle.
+  static std::unique_ptr<DynamicSpanningTree> Create(
+      const size_t vertex_no, const SpanningTree& tree,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    std::unique_ptr<DynamicSpanningTree> dynamic(new DynamicSpanningTree(vertex_no, resource));
+    for (const auto& [edge, weight] : tree) {
+      if (static_cast<size_t>(std::max(edge.first, edge.second)) >= vertex_no || edge.first == edge.second ||
+          dynamic->Connected(edge.first, edge.second))
+        return nullptr;
+      dynamic->Link(edge.first, edge.second, weight);
+    }
+    return dynamic;
+  }
+
+  // Sum of the tree weights, maintained on every change.
+  Cost TotalCost() const { return cost_; }
+  size_t EdgesNo() const { return index_.size(); }
+  const Instr& Instrumentation() const { return instr_; }
+
+  // Offer the edge (u, v) to the tree, return whether the tree changed. Return
+  // false for a self-loop or a vertex out of range.
+  bool InsertEdge(const Vertex u, const Vertex v, const Weight w) {
+    if (u == v || static_cast<size_t>(std::max(u, v)) >= vertex_no_) return false;
+    instr_.EdgeScan();
+    const auto it = index_.find(Key(u, v));
+    if (it != index_.end()) {
+      // Already a tree edge, only a lighter weight matters.
+      if (w >= weights_[it->second]) return false;
+      Lower(it->second, w);
+      return true;
+    }
+    if (!Connected(u, v)) {
+      Link(u, v, w);
+      return true;
+    }
+    const size_t heaviest = PathMax(u, v);
+    if (weights_[heaviest] <= w) return false;
+    Cut(heaviest);
+    Link(u, v, w);
+    return true;
+  }
+
+  // Lower the weight of the edge (u, v) to `w`. An edge outside of the tree
+  // is not kept, so this is an insertion of it with the new weight.
+  bool DecreaseWeight(const Vertex u, const Vertex v, const Weight w) { return InsertEdge(u, v, w); }
+
+  // Offer every edge of `edges`, return the number of changes of the tree.
+  size_t InsertEdges(const std::vector<WEdge>& edges) {
+    size_t changes = 0;
+    for (const auto& [edge, weight] : edges) changes += InsertEdge(edge.first, edge.second, weight);
+    return changes;
+  }
+
+  std::unique_ptr<SpanningTree> Tree(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+    auto spanning_tree = std::make_unique<SpanningTree>(resource);
+    for (const auto& [edge, node] : index_) spanning_tree->emplace(edge, weights_[node]);
+    return spanning_tree;
+  }
+
+ private:
+  // Nodes [0, vertex_no) are the vertices, the following ones the edges.
+  struct Node {
+    size_t child[2]{kNil, kNil};
+    size_t parent{kNil};
+    size_t heaviest;  // Heaviest edge node of the splay subtree.
+    bool flip{false};
+  };
+
+  DynamicSpanningTree(const size_t vertex_no, std::pmr::memory_resource* resource)
+      : vertex_no_(vertex_no),
+        nodes_(resource),
+        weights_(resource),
+        ends_(resource),
+        free_(resource),
+        index_(resource),
+        path_(resource) {
+    const size_t node_no = vertex_no + std::max(vertex_no, size_t{1}) - 1;
+    nodes_.resize(node_no);
+    // Vertex nodes never win a maximum.
+    weights_.resize(node_no, std::numeric_limits<Weight>::lowest());
+    ends_.resize(node_no);
+    for (size_t x = 0; x < node_no; ++x) nodes_[x].heaviest = x;
+    for (size_t x = node_no; x > vertex_no; --x) free_.push_back(x - 1);
+  }
+
+  static Edge Key(const Vertex u, const Vertex v) { return u < v ? Edge(u, v) : Edge(v, u); }
+
+  void Link(const Vertex u, const Vertex v, const Weight w) {
+    instr_.Union();
+    const size_t e = free_.back();
+    free_.pop_back();
+    nodes_[e] = Node();
+    nodes_[e].heaviest = e;
+    weights_[e] = w;
+    ends_[e] = Key(u, v);
+    index_.emplace(ends_[e], e);
+    cost_ += w;
+    MakeRoot(u);
+    nodes_[u].parent = e;
+    nodes_[e].parent = v;
+  }
+
+  void Cut(const size_t e) {
+    const auto [u, v] = ends_[e];
+    CutAdjacent(u, e);
+    CutAdjacent(e, v);
+    index_.erase(ends_[e]);
+    cost_ -= weights_[e];
+    free_.push_back(e);
+  }
+
+  // Remove the link between the adjacent nodes `x` and `y`.
+  void CutAdjacent(const size_t x, const size_t y) {
+    MakeRoot(x);
+    Access(y);
+    Splay(y);
+    nodes_[y].child[0] = kNil;
+    nodes_[x].parent = kNil;
+    Update(y);
+  }
+
+  void Lower(const size_t e, const Weight w) {
+    Splay(e);
+    cost_ -= weights_[e] - w;
+    weights_[e] = w;
+    Update(e);
+  }
+
+  bool Connected(const Vertex u, const Vertex v) {
+    instr_.Find();
+    return FindRoot(u) == FindRoot(v);
+  }
+
+  // Heaviest edge node on the tree path between `u` and `v`.
+  size_t PathMax(const Vertex u, const Vertex v) {
+    MakeRoot(u);
+    Access(v);
+    Splay(v);
+    return nodes_[v].heaviest;
+  }
+
+  bool IsSplayRoot(const size_t x) const {
+    const size_t p = nodes_[x].parent;
+    return p == kNil || (nodes_[p].child[0] != x && nodes_[p].child[1] != x);
+  }
+
+  void Push(const size_t x) {
+    Node& node = nodes_[x];
+    if (!node.flip) return;
+    std::swap(node.child[0], node.child[1]);
+    for (const size_t c : node.child)
+      if (c != kNil) nodes_[c].flip = !nodes_[c].flip;
+    node.flip = false;
+  }
+
+  void Update(const size_t x) {
+    Node& node = nodes_[x];
+    node.heaviest = x;
+    for (const size_t c : node.child)
+      if (c != kNil && weights_[nodes_[c].heaviest] > weights_[node.heaviest]) node.heaviest = nodes_[c].heaviest;
+  }
+
+  void Rotate(const size_t x) {
+    const size_t p = nodes_[x].parent;
+    const size_t g = nodes_[p].parent;
+    const int side = nodes_[p].child[1] == x;
+    if (!IsSplayRoot(p)) nodes_[g].child[nodes_[g].child[1] == p] = x;
+    nodes_[x].parent = g;
+    const size_t moved = nodes_[x].child[side ^ 1];
+    nodes_[p].child[side] = moved;
+    if (moved != kNil) nodes_[moved].parent = p;
+    nodes_[x].child[side ^ 1] = p;
+    nodes_[p].parent = x;
+    Update(p);
+    Update(x);
+  }
+
+  void Splay(const size_t x) {
+    // Push the pending flips down from the splay root first.
+    path_.clear();
+    for (size_t y = x;; y = nodes_[y].parent) {
+      path_.push_back(y);
+      if (IsSplayRoot(y)) break;
+    }
+    for (auto it = path_.rbegin(); it != path_.rend(); ++it) Push(*it);
+    while (!IsSplayRoot(x)) {
+      const size_t p = nodes_[x].parent;
+      if (!IsSplayRoot(p)) {
+        const size_t g = nodes_[p].parent;
+        Rotate((nodes_[g].child[1] == p) == (nodes_[p].child[1] == x) ? p : x);
+      }
+      Rotate(x);
+    }
+  }
+
+  // Make the path from the root of the tree to `x` preferred.
+  void Access(const size_t x) {
+    for (size_t y = x, last = kNil; y != kNil; last = y, y = nodes_[y].parent) {
+      Splay(y);
+      nodes_[y].child[1] = last;
+      Update(y);
+    }
+    Splay(x);
+  }
+
+  void MakeRoot(const size_t x) {
+    Access(x);
+    nodes_[x].flip = !nodes_[x].flip;
+  }
+
+  size_t FindRoot(size_t x) {
+    Access(x);
+    for (Push(x); nodes_[x].child[0] != kNil; Push(x)) x = nodes_[x].child[0];
+    Splay(x);
+    return x;
+  }
+
+  const size_t vertex_no_;
+  Instr instr_;
+  std::pmr::vector<Node> nodes_;
+  std::pmr::vector<Weight> weights_;
+  std::pmr::vector<Edge> ends_;   // Endpoints of the edge nodes.
+  std::pmr::vector<size_t> free_;  // Unused edge nodes.
+  std::pmr::map<Edge, size_t> index_;  // Tree edge -> its node.
+  std::pmr::vector<size_t> path_;
+  Cost cost_{0};
+};
+
+}  // namespace sdizo::mst
+
+#endif  // SDIZO_DYNAMICMST_HPP_
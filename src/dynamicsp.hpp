@@ -0,0 +1,266 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_DYNAMICSP_HPP_
+#define SDIZO_DYNAMICSP_HPP_
+
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "dheap.hpp"
+#include "graph.hpp"
+#include "instrument.hpp"
+#include "shortestpath.hpp"
+
+namespace sdizo::shortestpath {
+
+// Shortest paths from `vb` kept up to date while the graph changes. Every edge
+// update goes through this object, which repairs the distances and the
+// predecessors in the Ramalingam-Reps manner: a lowered weight propagates
+// Dijkstra-style from the improved vertex, a raised or removed tree edge resets
+// only the subtree hanging below it and rebuilds it from its unaffected
+// in-neighbours. The work is proportional to the changed part of the tree, not
+// to the graph. Weights must be non-negative and the vertex set stays fixed.
+template <typename GRepr, typename Instr = instrument::Disabled>
+class DynamicShortestPath {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Weight = typename Graph<GRepr>::Weight;
+  using PathCost = typename Graph<GRepr>::PathCost;
+  using Length = typename Graph<GRepr>::Distance;
+  using Connection = typename Graph<GRepr>::Connection;
+  static constexpr Length kInf = kDistanceInf<Length>;
+
+ public:
+  // Return nullptr if `vb` is not a vertex of `g` or `g` has a negative weight.
+  static std::unique_ptr<DynamicShortestPath> Create(
+      std::shared_ptr<GRepr> g, const Vertex vb,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    const size_t vertex_no = g->VerticesNo();
+    if (static_cast<size_t>(vb) >= vertex_no) return nullptr;
+    bool negative = false;
+    for (size_t u = 0; u < vertex_no; ++u)
+      g->ForEachNeighbour(u, [&negative](Vertex, const Weight weight) { negative |= weight < 0; });
+    if (negative) return nullptr;
+    return std::unique_ptr<DynamicShortestPath>(new DynamicShortestPath(g, vb, resource));
+  }
+
+  const PathCost& Paths() const { return *path_cost_; }
+  Vertex Source() const { return vb_; }
+  const Instr& Instrumentation() const { return instr_; }
+
+  // Add the edge (u, v). An adjacency matrix holds a single edge per pair, so
+  // there an existing edge gets the new weight. Return false for a negative
+  // weight or a vertex out of range.
+  bool AddEdge(const Vertex u, const Vertex v, const Weight w) {
+    if (!InRange(u, v) || w < 0) return false;
+    if constexpr (IsAdjacencyMatrix<GRepr>::value) {
+      Weight previous;
+      if (FindWeight(u, v, previous)) return UpdateWeight(u, v, w);
+      if (w == 0) return true;  // A zero weight is no edge.
+    }
+    g_->AddEdge(u, v, w);
+    if constexpr (GRepr::kIsDirected) incoming_[v].emplace_back(u, w);
+    Lowered(u, v, w);
+    return true;
+  }
+
+  // Remove the edge (u, v), return false if there is none.
+  bool RemoveEdge(const Vertex u, const Vertex v) {
+    Weight previous;
+    if (!InRange(u, v) || !FindWeight(u, v, previous) || !g_->RemoveEdge(u, v)) return false;
+    if constexpr (GRepr::kIsDirected) EraseIncoming(u, v, previous);
+    Raised(u, v);
+    return true;
+  }
+
+  // Set the weight of the edge (u, v), return false if there is none or `w` is
+  // negative.
+  bool UpdateWeight(const Vertex u, const Vertex v, const Weight w) {
+    Weight previous;
+    if (!InRange(u, v) || w < 0 || !FindWeight(u, v, previous)) return false;
+    if (IsAdjacencyMatrix<GRepr>::value && w == 0) return RemoveEdge(u, v);
+    g_->UpdateWeight(u, v, w);
+    if constexpr (GRepr::kIsDirected) {
+      for (Connection& connection : incoming_[v]) {
+        if (connection.first == u && connection.second == previous) {
+          connection.second = w;
+          break;
+        }
+      }
+    }
+    if (w < previous)
+      Lowered(u, v, w);
+    else if (w > previous)
+      Raised(u, v);
+    return true;
+  }
+
+ private:
+  DynamicShortestPath(std::shared_ptr<GRepr> g, const Vertex vb, std::pmr::memory_resource* resource)
+      : g_(g),
+        vb_(vb),
+        path_cost_(Dijkstra<GRepr>(std::shared_ptr<const Graph<GRepr>>(g), vb, instr_, resource)),
+        incoming_(resource),
+        affected_(resource),
+        stack_(resource),
+        Q_(resource) {
+    const size_t vertex_no = path_cost_->first.size();
+    if constexpr (GRepr::kIsDirected) {
+      incoming_.resize(vertex_no);
+      for (size_t u = 0; u < vertex_no; ++u)
+        g_->ForEachNeighbour(u, [&](const Vertex v, const Weight weight) { incoming_[v].emplace_back(u, weight); });
+    }
+    affected_.resize(vertex_no);
+    Q_.Resize(vertex_no);
+  }
+
+  bool InRange(const Vertex u, const Vertex v) const {
+    return static_cast<size_t>(std::max(u, v)) < path_cost_->first.size();
+  }
+
+  // Weight of the first arc (u, v), the one the graph removes or updates.
+  bool FindWeight(const Vertex u, const Vertex v, Weight& w) const {
+    bool found = false;
+    g_->ForEachNeighbour(u, [&](const Vertex x, const Weight weight) {
+      if (!found && x == v) {
+        found = true;
+        w = weight;
+      }
+    });
+    return found;
+  }
+
+  void EraseIncoming(const Vertex u, const Vertex v, const Weight w) {
+    auto& connections = incoming_[v];
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+      if (it->first == u && it->second == w) {
+        connections.erase(it);
+        return;
+      }
+    }
+  }
+
+  // The arc (u, v) got cheaper or appeared.
+  void Lowered(const Vertex u, const Vertex v, const Weight w) {
+    Relax(u, v, w);
+    if constexpr (!GRepr::kIsDirected) Relax(v, u, w);
+    Propagate();
+  }
+
+  // The arc (u, v) got more expensive or disappeared. Only the subtree below a
+  // tree arc can lose its distances.
+  void Raised(const Vertex u, const Vertex v) {
+    auto& [predecessors, distances] = *path_cost_;
+    Vertex root = vb_;
+    if (v != vb_ && distances[v] != kInf && predecessors[v] == u)
+      root = v;
+    else if (!GRepr::kIsDirected && u != vb_ && distances[u] != kInf && predecessors[u] == v)
+      root = u;
+    if (root == vb_) return;
+    // Collect the subtree of `root` and reset it.
+    stack_.push_back(root);
+    affected_[root] = true;
+    for (size_t i = 0; i < stack_.size(); ++i) {
+      const Vertex x = stack_[i];
+      g_->ForEachNeighbour(x, [&](const Vertex y, Weight) {
+        instr_.EdgeScan();
+        if (!affected_[y] && y != vb_ && distances[y] != kInf && predecessors[y] == x) {
+          affected_[y] = true;
+          stack_.push_back(y);
+        }
+      });
+    }
+    for (const Vertex x : stack_) {
+      predecessors[x] = 0;
+      distances[x] = kInf;
+    }
+    // Reconnect the subtree through its unaffected in-neighbours.
+    for (const Vertex y : stack_) {
+      const auto seed = [&](const Vertex x, const Weight weight) {
+        instr_.EdgeScan();
+        if (!affected_[x] && distances[x] != kInf && distances[x] + weight < distances[y]) {
+          distances[y] = distances[x] + weight;
+          predecessors[y] = x;
+        }
+      };
+      if constexpr (GRepr::kIsDirected) {
+        for (const auto& [x, weight] : incoming_[y]) seed(x, weight);
+      } else {
+        g_->ForEachNeighbour(y, seed);
+      }
+      if (distances[y] != kInf) {
+        instr_.Relaxation();
+        Enqueue(y);
+      }
+    }
+    for (const Vertex x : stack_) affected_[x] = false;
+    stack_.clear();
+    Propagate();
+  }
+
+  void Relax(const Vertex u, const Vertex v, const Weight w) {
+    auto& [predecessors, distances] = *path_cost_;
+    instr_.EdgeScan();
+    if (distances[u] == kInf || distances[u] + w >= distances[v]) return;
+    instr_.Relaxation();
+    distances[v] = distances[u] + w;
+    predecessors[v] = u;
+    Enqueue(v);
+  }
+
+  void Enqueue(const Vertex v) {
+    if (Q_.Push(v, path_cost_->second[v]))
+      instr_.HeapPush();
+    else
+      instr_.DecreaseKey();
+  }
+
+  // Dijkstra's algorithm from the queued vertices, every other vertex already
+  // has its final distance.
+  void Propagate() {
+    auto& [predecessors, distances] = *path_cost_;
+    while (!Q_.Empty()) {
+      const Vertex u = Q_.Pop().first;
+      instr_.HeapPop();
+      g_->ForEachNeighbour(u, [&](const Vertex v, const Weight weight) {
+        instr_.EdgeScan();
+        const Length new_distance = distances[u] + weight;
+        if (new_distance < distances[v]) {
+          instr_.Relaxation();
+          distances[v] = new_distance;
+          predecessors[v] = u;
+          Enqueue(v);
+        }
+      });
+    }
+  }
+
+  std::shared_ptr<GRepr> g_;
+  const Vertex vb_;
+  Instr instr_;
+  std::unique_ptr<PathCost> path_cost_;
+  // v -> [(u, weight), ...] of the arcs entering v, directed graphs only.
+  std::pmr::vector<std::pmr::vector<Connection>> incoming_;
+  std::pmr::vector<bool> affected_;
+  std::pmr::vector<Vertex> stack_;
+  IndexedQueue<Length, Vertex> Q_;
+};
+
+}  // namespace sdizo::shortestpath
+
+#endif  // SDIZO_DYNAMICSP_HPP_
@@ -15,9 +15,11 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <memory>
+#include <vector>
 
 #include "graph.hpp"
 #include "graphreader.hpp"
+#include "idmap.hpp"
 #include "mst.hpp"
 #include "shortestpath.hpp"
 #include "test.hpp"
@@ -31,49 +33,57 @@ bool Example(const util::Args& args) {
   }
 
   GraphReader reader;
+  IdMap id_map;
+  const IdMap* ids = args.IsFlag("compact-ids") ? &id_map : nullptr;
+  if (ids != nullptr) reader.CompactIds(&id_map);
   size_t v, e, vb, ve;
   if (!reader.Open(args.GetValue("input"), v, e, &vb, &ve)) return false;
   const Vertex avb(vb);
-  auto g_matrix = std::make_shared<AdjacencyMatrix>(false, v);
-  auto g_list = std::make_shared<AdjacencyList>(false, v);
-  auto g_matrix_d = std::make_shared<AdjacencyMatrix>(true, v);
-  auto g_list_d = std::make_shared<AdjacencyList>(true, v);
+  std::vector<WEdge> edges;
   int32_t w;
-  while (reader.ReadEdge(vb, ve, &w)) {
-    g_matrix->AddEdge(vb, ve, w);
-    g_list->AddEdge(vb, ve, w);
-    g_matrix_d->AddEdge(vb, ve, w);
-    g_list_d->AddEdge(vb, ve, w);
+  while (reader.ReadEdge(vb, ve, &w)) edges.emplace_back(Edge(vb, ve), w);
+  if (edges.size() != e) return false;
+  // Compacted ids are all known after the last edge.
+  if (ids != nullptr) v = ids->Size();
+  auto g_matrix = std::make_shared<UndirectedMatrix>(v);
+  auto g_list = std::make_shared<UndirectedList>(v);
+  auto g_matrix_d = std::make_shared<DirectedMatrix>(v);
+  auto g_list_d = std::make_shared<DirectedList>(v);
+  for (const auto& [edge, weight] : edges) {
+    g_matrix->AddEdge(edge.first, edge.second, weight);
+    g_list->AddEdge(edge.first, edge.second, weight);
+    g_matrix_d->AddEdge(edge.first, edge.second, weight);
+    g_list_d->AddEdge(edge.first, edge.second, weight);
   }
   std::printf("Matrix\n");
   g_matrix->Print();
   std::printf("Matrix: PRIM\n");
-  detail::Print(*mst::Prim<AdjacencyMatrix>(g_matrix));
+  detail::Print(*mst::Prim<UndirectedMatrix>(g_matrix), ids);
   std::printf("Matrix: KRUSKAL\n");
-  detail::Print(*mst::Kruskal<AdjacencyMatrix>(g_matrix));
+  detail::Print(*mst::Kruskal<UndirectedMatrix>(g_matrix), ids);
   std::printf("Matrix: DIJKSTRA\n");
-  detail::Print(avb, *shortestpath::Dijkstra<AdjacencyMatrix>(g_matrix_d, avb));
+  detail::Print(avb, *shortestpath::Dijkstra<DirectedMatrix>(g_matrix_d, avb), ids);
   {
-    auto path_cost = shortestpath::BellmanFord<AdjacencyMatrix>(g_matrix_d, avb);
+    auto path_cost = shortestpath::BellmanFord<DirectedMatrix>(g_matrix_d, avb);
     if (path_cost) {
       std::printf("Matrix: BELLMAN-FORD\n");
-      detail::Print(avb, *path_cost);
+      detail::Print(avb, *path_cost, ids);
     }
   }
 
   std::printf("List:\n");
   g_list->Print();
   std::printf("List: PRIM\n");
-  detail::Print(*mst::Prim<AdjacencyList>(g_list));
+  detail::Print(*mst::Prim<UndirectedList>(g_list), ids);
   std::printf("List: KRUSKAL\n");
-  detail::Print(*mst::Kruskal<AdjacencyList>(g_list));
+  detail::Print(*mst::Kruskal<UndirectedList>(g_list), ids);
   std::printf("List: DIJKSTRA\n");
-  detail::Print(avb, *shortestpath::Dijkstra<AdjacencyList>(g_list_d, avb));
+  detail::Print(avb, *shortestpath::Dijkstra<DirectedList>(g_list_d, avb), ids);
   {
-    auto path_cost = shortestpath::BellmanFord<AdjacencyList>(g_list_d, avb);
+    auto path_cost = shortestpath::BellmanFord<DirectedList>(g_list_d, avb);
     if (path_cost) {
       std::printf("List: BELLMAN-FORD\n");
-      detail::Print(avb, *path_cost);
+      detail::Print(avb, *path_cost, ids);
     }
   }
   return true;
@@ -14,32 +14,55 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <signal.h>
+
 #include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "async.hpp"
 #include "graph.hpp"
 #include "graphgenerator.hpp"
 #include "graphreader.hpp"
+#include "idmap.hpp"
+#include "instrument.hpp"
 #include "mst.hpp"
+#include "output.hpp"
+#include "parallel.hpp"
+#include "reorder.hpp"
 #include "shortestpath.hpp"
 #include "test.hpp"
 
 namespace sdizo::test {
 namespace {
 
-bool LoadGraph(std::vector<WEdge>& edges, size_t& vertices, const char* input, Vertex* vb = nullptr) {
+// Cancelled by SIGINT to interrupt the running menu command.
+async::CancellationToken interrupt;
+
+void Interrupt(int) { interrupt.Cancel(); }
+
+// Load the graph of `input`, with the vertex labels compacted by `ids` if given.
+bool LoadGraph(std::vector<WEdge>& edges, size_t& vertices, const char* input, Vertex* vb = nullptr,
+               IdMap* ids = nullptr) {
   size_t v, e;
   Vertex ub, ue;
   Weight weight;
   [[maybe_unused]] Vertex ve;
   GraphReader reader;
+  if (ids != nullptr) reader.CompactIds(ids);
   if (!reader.Open(input, v, e, vb, &ve)) return false;
-  vertices = v;
   while (reader.ReadEdge(ub, ue, &weight)) edges.emplace_back(Edge(ub, ue), weight);
+  if (edges.size() != e) return false;
+  vertices = ids != nullptr ? ids->Size() : v;
   return true;
 }
 
@@ -71,14 +94,32 @@ bool GetToken(std::string_view& line, std::string_view& token, const char* label
 template <typename T>
 bool ParseNum(std::string_view token, T& val, const char* label = nullptr) {
   auto parsed = std::from_chars(token.data(), token.end(), val);
-  if (parsed.ec != std::errc::invalid_argument) return true;
+  if (parsed.ec == std::errc()) return true;
   if (label != nullptr) std::printf("Error: Invalid %s value\n", label);
   return false;
 }
 
+bool ParseOrdering(std::string_view token, reorder::Ordering& ordering) {
+  if (token.compare("none"sv) == 0)
+    ordering = reorder::Ordering::kNone;
+  else if (token.compare("bfs"sv) == 0)
+    ordering = reorder::Ordering::kBfs;
+  else if (token.compare("degree"sv) == 0)
+    ordering = reorder::Ordering::kDegree;
+  else if (token.compare("rcm"sv) == 0)
+    ordering = reorder::Ordering::kRcm;
+  else
+    return false;
+  return true;
+}
+
 class Ctx {
  public:
-  Ctx() { cmds_["help"] = std::make_pair("", std::bind(&Ctx::Help, this, _1)); }
+  Ctx() {
+    cmds_["help"] = std::make_pair("", std::bind(&Ctx::Help, this, _1));
+    cmds_["counters"] = std::make_pair("{on | off}", std::bind(&Ctx::SetCounters, this, _1));
+    cmds_["output"] = std::make_pair("{paths | parents | binary <path>}", std::bind(&Ctx::SetOutput, this, _1));
+  }
   virtual ~Ctx() = default;
 
   virtual const char* Name() const = 0;
@@ -96,9 +137,97 @@ class Ctx {
   }
 
  protected:
+  // Run `fn` with the instrumentation policy selected by the `counters` command
+  // and print the collected counters, if enabled, after `print` consumed the
+  // result. A run interrupted by SIGINT, since the command was dispatched,
+  // prints nothing.
+  template <typename Fn, typename PrintFn>
+  void Run(Fn fn, PrintFn print) const {
+    if (!counters_) {
+      Run<instrument::Disabled>(fn, print);
+      return;
+    }
+    if (const auto instr = Run<instrument::Enabled>(fn, print); instr.has_value()) detail::Print(*instr);
+  }
+
+  // Print the shortest paths from `vb` in the format selected by the `output`
+  // command.
+  void Output(const Vertex vb, const PathCost& path_cost, const IdMap* ids) const {
+    if (binary_path_.empty())
+      detail::Print(vb, path_cost, ids, path_format_);
+    else
+      WriteBinary([&](output::Writer& out) { detail::Write(out, vb, path_cost, ids); });
+  }
+  void Output(const SpanningTree& spanning_tree, const IdMap* ids) const {
+    if (binary_path_.empty())
+      detail::Print(spanning_tree, ids);
+    else
+      WriteBinary([&](output::Writer& out) { detail::Write(out, spanning_tree, ids); });
+  }
+
   CmdMap cmds_;
 
  private:
+  // Replace the file of the `output binary` command by what `write` writes.
+  template <typename WriteFn>
+  void WriteBinary(WriteFn write) const {
+    FILE* fp = std::fopen(binary_path_.c_str(), "wb");
+    if (fp == nullptr) {
+      std::printf("Error: Cannot open %s\n", binary_path_.c_str());
+      return;
+    }
+    bool written;
+    {
+      output::Writer out(fp);
+      write(out);
+      written = out.Flush();
+    }
+    if (std::fclose(fp) != 0 || !written) std::printf("Error: Cannot write %s\n", binary_path_.c_str());
+  }
+
+  template <typename Base, typename Fn, typename PrintFn>
+  std::optional<async::Cancellable<Base>> Run(Fn& fn, PrintFn& print) const {
+    async::Cancellable<Base> instr(interrupt);
+    auto result = fn(instr);
+    if (instr.Stopped() != async::Status::kRunning) {
+      std::printf("Warning: Interrupted\n");
+      return std::nullopt;
+    }
+    print(std::move(result));
+    return instr;
+  }
+
+  void SetCounters(std::string_view line) {
+    std::string_view token;
+    if (!GetToken(line, token, "argument")) return;
+    if (token.compare("on"sv) == 0)
+      counters_ = true;
+    else if (token.compare("off"sv) == 0)
+      counters_ = false;
+    else
+      std::printf("Error: Invalid argument, should be on or off\n");
+  }
+
+  void SetOutput(std::string_view line) {
+    std::string_view token;
+    if (!GetToken(line, token, "argument")) return;
+    if (token.compare("binary"sv) == 0) {
+      std::string_view path;
+      if (!GetToken(line, path, "path")) return;
+      binary_path_ = path;
+      return;
+    }
+    if (token.compare("paths"sv) == 0)
+      path_format_ = PathFormat::kPaths;
+    else if (token.compare("parents"sv) == 0)
+      path_format_ = PathFormat::kParents;
+    else {
+      std::printf("Error: Invalid argument, should be paths, parents or binary\n");
+      return;
+    }
+    binary_path_.clear();
+  }
+
   void Help(std::string_view) const {
     for (const CmdMap::value_type& pair : cmds_)
       if (pair.second.first.size())
@@ -106,6 +235,95 @@ class Ctx {
       else
         std::printf("?%s\n", pair.first.c_str());
   }
+
+  bool counters_{false};
+  PathFormat path_format_{PathFormat::kPaths};
+  // File of the binary results, empty if they are printed.
+  std::string binary_path_;
+};
+
+// Adjacency list and matrix of an edge set, each built on its first use and
+// relabelled by the ordering of the `reorder` command. A build is abandoned,
+// and reported, if `token` is cancelled meanwhile.
+template <typename ListRepr, typename MatrixRepr>
+class Representations {
+ public:
+  explicit Representations(const async::CancellationToken* token = nullptr) : token_(token) {}
+
+  void Load(std::shared_ptr<const std::vector<WEdge>> edges, const size_t vertices) {
+    edges_ = std::move(edges);
+    vertices_ = vertices;
+    permutation_.reset();
+    list_.reset();
+    matrix_.reset();
+  }
+
+  bool Empty() const { return edges_ == nullptr; }
+  size_t VerticesNo() const { return vertices_; }
+  // Relabelling of the graphs, nullptr if they keep the original ids.
+  const reorder::Permutation<Vertex>* Permutation() const { return permutation_.get(); }
+
+  // nullptr if the build was interrupted.
+  std::shared_ptr<ListRepr> List() const {
+    if (list_ == nullptr) list_ = Build<ListRepr>();
+    return list_;
+  }
+  // nullptr if the matrix would not fit in the memory, which is reported unless
+  // `quiet`, or if the build was interrupted.
+  std::shared_ptr<MatrixRepr> Matrix(const bool quiet = false) const {
+    if (matrix_ != nullptr) return matrix_;
+    const size_t bytes = MatrixRepr::EstimateBytes(vertices_);
+    if (const size_t memory = PhysicalMemory(); memory != 0 && bytes > memory) {
+      if (!quiet)
+        std::printf("Error: Adjacency matrix needs %.1f MB, the machine has %.1f MB\n", bytes / 1e6, memory / 1e6);
+      return nullptr;
+    }
+    matrix_ = Build<MatrixRepr>();
+    return matrix_;
+  }
+
+  // The ordering is computed on the original ids, so the built graphs are
+  // dropped and rebuilt relabelled on their next use. An interrupted reorder
+  // keeps the original ids.
+  void Reorder(const reorder::Ordering ordering) {
+    permutation_.reset();
+    list_.reset();
+    matrix_.reset();
+    if (ordering == reorder::Ordering::kNone) return;
+    const auto list = List();
+    if (list == nullptr) return;
+    auto permutation = reorder::ComputeOrdering<ListRepr>(list, ordering);
+    if (Interrupted()) return;
+    auto relabelled = reorder::Relabel<ListRepr>(list, *permutation);
+    if (Interrupted()) return;
+    permutation_ = std::move(permutation);
+    list_ = std::move(relabelled);
+  }
+
+ private:
+  template <typename GRepr>
+  std::shared_ptr<GRepr> Build() const {
+    auto g = std::make_shared<GRepr>(vertices_);
+    g->AddEdges(*edges_);
+    if (Interrupted()) return nullptr;
+    if (permutation_ != nullptr) g = reorder::Relabel<GRepr>(g, *permutation_);
+    if (Interrupted()) return nullptr;
+    return g;
+  }
+
+  // Whether the token was cancelled, which is reported.
+  bool Interrupted() const {
+    if (token_ == nullptr || !token_->Cancelled()) return false;
+    std::printf("Warning: Interrupted\n");
+    return true;
+  }
+
+  const async::CancellationToken* token_;
+  std::shared_ptr<const std::vector<WEdge>> edges_;
+  size_t vertices_{0};
+  std::unique_ptr<reorder::Permutation<Vertex>> permutation_;
+  mutable std::shared_ptr<ListRepr> list_;
+  mutable std::shared_ptr<MatrixRepr> matrix_;
 };
 
 class Directed : public Ctx {
@@ -114,37 +332,50 @@ class Directed : public Ctx {
     cmds_["generate"] = std::make_pair("<vertices> <density>", std::bind(&Directed::GenerateGraph, this, _1));
     cmds_["list"] = std::make_pair("", std::bind(&Directed::PrintList, this, _1));
     cmds_["matrix"] = std::make_pair("", std::bind(&Directed::PrintMatrix, this, _1));
+    cmds_["reorder"] = std::make_pair("{none | bfs | degree | rcm}", std::bind(&Directed::Reorder, this, _1));
     cmds_["dijkstra"] = std::make_pair("{list | matrix} [vstart]", std::bind(&Directed::Dijkstra, this, _1));
     cmds_["bellmanford"] = std::make_pair("{list | matrix} [vstart]", std::bind(&Directed::BellmanFord, this, _1));
   }
 
   const char* Name() const { return "directed"; }
 
-  void Load(const std::vector<WEdge>& edges, const size_t vertices, const Vertex vb) {
+  // Load the graph, whose vertices are the labels of `ids` if given. The
+  // representations are built on their first use.
+  void Load(std::shared_ptr<const std::vector<WEdge>> edges, const size_t vertices, const Vertex vb,
+            std::shared_ptr<const IdMap> ids = nullptr) {
     vb_ = vb;
-    g_matrix_ = std::make_shared<AdjacencyMatrix>(true, vertices);
-    g_list_ = std::make_shared<AdjacencyList>(true, vertices);
-    std::for_each(edges.cbegin(), edges.cend(), [this](const WEdge& edge) {
-      g_list_->AddEdge(edge);
-      g_matrix_->AddEdge(edge);
-    });
+    ids_ = std::move(ids);
+    graphs_.Load(std::move(edges), vertices);
   }
 
  private:
   void PrintList(std::string_view) const {
-    if (g_list_ != nullptr)
-      g_list_->Print();
-    else
+    if (graphs_.Empty())
       std::printf("Error: Adjacency list is empty\n");
+    else if (const auto g_list = graphs_.List(); g_list != nullptr)
+      g_list->Print();
   }
   void PrintMatrix(std::string_view) const {
-    if (g_matrix_ != nullptr)
-      g_matrix_->Print();
-    else
+    if (graphs_.Empty())
       std::printf("Error: Adjacency matrix is empty\n");
+    else if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+      g_matrix->Print();
+  }
+  // Parse the optional start vertex of `line` into `vb`, false if invalid.
+  bool ParseStart(std::string_view line, Vertex& vb) const {
+    std::string_view token;
+    uint64_t vstart;
+    vb = vb_;
+    if (!GetToken(line, token)) return true;
+    if (!ParseNum(token, vstart) || (ids_ != nullptr ? !ids_->Find(vstart, vb) : vstart >= graphs_.VerticesNo())) {
+      std::printf("Warning: Invalid start vertex\n");
+      return false;
+    }
+    if (ids_ == nullptr) vb = vstart;
+    return true;
   }
   void Dijkstra(std::string_view line) const {
-    if (g_list_ == nullptr || g_matrix_ == nullptr) {
+    if (graphs_.Empty()) {
       std::printf("Error: Graph does not exist\n");
       return;
     }
@@ -153,25 +384,26 @@ class Directed : public Ctx {
       std::printf("Error: Missing representation\n");
       return;
     }
-    std::string_view token;
-    long vstart;
-    Vertex vb = vb_;
-    if (GetToken(line, token)) {
-      if (!ParseNum(token, vstart) || vstart < 0 || static_cast<size_t>(vstart) >= g_list_->VerticesNo()) {
-        std::printf("Warning: Invalid start vertex\n");
-        return;
-      }
-      vb = vstart;
-    }
-    if (representation.compare("list"sv) == 0)
-      detail::Print(vb, *shortestpath::Dijkstra<AdjacencyList>(g_list_, vb));
-    else if (representation.compare("matrix"sv) == 0)
-      detail::Print(vb, *shortestpath::Dijkstra<AdjacencyMatrix>(g_matrix_, vb));
-    else
+    Vertex vb;
+    if (!ParseStart(line, vb)) return;
+    const auto* permutation = graphs_.Permutation();
+    const auto print = [this, vb, permutation](std::unique_ptr<PathCost> path_cost) {
+      if (permutation != nullptr) reorder::Restore(*path_cost, *permutation);
+      Output(vb, *path_cost, ids_.get());
+    };
+    const Vertex vr = permutation != nullptr ? permutation->to_new[vb] : vb;
+    if (representation.compare("list"sv) == 0) {
+      if (const auto g_list = graphs_.List(); g_list != nullptr)
+        Run([&](auto& instr) { return shortestpath::Dijkstra<DirectedList>(g_list, vr, instr); }, print);
+    } else if (representation.compare("matrix"sv) == 0) {
+      if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+        Run([&](auto& instr) { return shortestpath::Dijkstra<DirectedMatrix>(g_matrix, vr, instr); }, print);
+    } else {
       std::printf("Error: Invalid graph representaton\n");
+    }
   }
   void BellmanFord(std::string_view line) const {
-    if (g_list_ == nullptr || g_matrix_ == nullptr) {
+    if (graphs_.Empty()) {
       std::printf("Error: Graph does not exist\n");
       return;
     }
@@ -180,29 +412,44 @@ class Directed : public Ctx {
       std::printf("Error: Missing representation\n");
       return;
     }
-    std::string_view token;
-    long vstart;
-    Vertex vb = vb_;
-    if (GetToken(line, token)) {
-      if (!ParseNum(token, vstart) || vstart < 0 || static_cast<size_t>(vstart) >= g_list_->VerticesNo()) {
-        std::printf("Warning: Invalid start vertex\n");
+    Vertex vb;
+    if (!ParseStart(line, vb)) return;
+    const auto* permutation = graphs_.Permutation();
+    const auto print = [this, vb, permutation](std::unique_ptr<PathCost> path_cost) {
+      if (!path_cost) {
+        std::printf("Warning: Detected negative cycle\n");
         return;
       }
-      vb = vstart;
-    }
-    std::unique_ptr<PathCost> path_cost = std::make_unique<PathCost>();
-    if (representation.compare("list"sv) == 0)
-      path_cost = shortestpath::BellmanFord<AdjacencyList>(g_list_, vb);
-    else if (representation.compare("matrix"sv) == 0)
-      path_cost = shortestpath::BellmanFord<AdjacencyMatrix>(g_matrix_, vb);
-    else {
+      if (permutation != nullptr) reorder::Restore(*path_cost, *permutation);
+      Output(vb, *path_cost, ids_.get());
+    };
+    const Vertex vr = permutation != nullptr ? permutation->to_new[vb] : vb;
+    if (representation.compare("list"sv) == 0) {
+      if (const auto g_list = graphs_.List(); g_list != nullptr)
+        Run([&](auto& instr) { return shortestpath::BellmanFord<DirectedList>(g_list, vr, instr); }, print);
+    } else if (representation.compare("matrix"sv) == 0) {
+      if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+        Run([&](auto& instr) { return shortestpath::BellmanFord<DirectedMatrix>(g_matrix, vr, instr); }, print);
+    } else {
       std::printf("Error: Invalid graph representaton\n");
+    }
+  }
+
+  // Relabel the graph for locality, the results are still reported with the
+  // original ids. The list and matrix commands print the relabelled graph.
+  void Reorder(std::string_view line) {
+    if (graphs_.Empty()) {
+      std::printf("Error: Graph does not exist\n");
       return;
     }
-    if (path_cost)
-      detail::Print(vb, *path_cost);
-    else
-      std::printf("Warning: Detected negative cycle\n");
+    std::string_view token;
+    if (!GetToken(line, token, "ordering")) return;
+    reorder::Ordering ordering;
+    if (!ParseOrdering(token, ordering)) {
+      std::printf("Error: Invalid ordering, should be none, bfs, degree or rcm\n");
+      return;
+    }
+    graphs_.Reorder(ordering);
   }
 
   void GenerateGraph(std::string_view line) {
@@ -222,12 +469,13 @@ class Directed : public Ctx {
       return;
     }
     Vertex vb;
-    std::vector<WEdge> edges = graph_gen_.Generate(vertices, density, true, &vb);
-    Load(edges, vertices, vb);
+    auto edges = std::make_shared<const std::vector<WEdge>>(graph_gen_.Generate(vertices, density, true, &vb));
+    Load(std::move(edges), vertices, vb);
   }
 
-  std::shared_ptr<AdjacencyList> g_list_{nullptr};
-  std::shared_ptr<AdjacencyMatrix> g_matrix_{nullptr};
+  Representations<DirectedList, DirectedMatrix> graphs_{&interrupt};
+  // Labels of the vertices of a compacted input, nullptr if they are the ids.
+  std::shared_ptr<const IdMap> ids_;
   GraphGenerator graph_gen_{true};
   Vertex vb_;
 };
@@ -238,36 +486,36 @@ class Undirected : public Ctx {
     cmds_["generate"] = std::make_pair("<vertices> <density>", std::bind(&Undirected::GenerateGraph, this, _1));
     cmds_["list"] = std::make_pair("", std::bind(&Undirected::PrintList, this, _1));
     cmds_["matrix"] = std::make_pair("", std::bind(&Undirected::PrintMatrix, this, _1));
+    cmds_["reorder"] = std::make_pair("{none | bfs | degree | rcm}", std::bind(&Undirected::Reorder, this, _1));
     cmds_["kruskal"] = std::make_pair("{list | matrix}", std::bind(&Undirected::Kruskal, this, _1));
     cmds_["prim"] = std::make_pair("{list | matrix}", std::bind(&Undirected::Prim, this, _1));
   }
 
   const char* Name() const { return "undirected"; }
 
-  void Load(const std::vector<WEdge>& edges, const size_t vertices) {
-    g_matrix_ = std::make_shared<AdjacencyMatrix>(false, vertices);
-    g_list_ = std::make_shared<AdjacencyList>(false, vertices);
-    std::for_each(edges.cbegin(), edges.cend(), [this](const WEdge& edge) {
-      g_list_->AddEdge(edge);
-      g_matrix_->AddEdge(edge);
-    });
+  // Load the graph, whose vertices are the labels of `ids` if given. The
+  // representations are built on their first use.
+  void Load(std::shared_ptr<const std::vector<WEdge>> edges, const size_t vertices,
+            std::shared_ptr<const IdMap> ids = nullptr) {
+    ids_ = std::move(ids);
+    graphs_.Load(std::move(edges), vertices);
   }
 
  private:
   void PrintList(std::string_view) const {
-    if (g_list_ != nullptr)
-      g_list_->Print();
-    else
+    if (graphs_.Empty())
       std::printf("Error: Adjacency list is empty\n");
+    else if (const auto g_list = graphs_.List(); g_list != nullptr)
+      g_list->Print();
   }
   void PrintMatrix(std::string_view) const {
-    if (g_matrix_ != nullptr)
-      g_matrix_->Print();
-    else
+    if (graphs_.Empty())
       std::printf("Error: Adjacency matrix is empty\n");
+    else if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+      g_matrix->Print();
   }
   void Kruskal(std::string_view line) const {
-    if (g_list_ == nullptr || g_matrix_ == nullptr) {
+    if (graphs_.Empty()) {
       std::printf("Error: Graph does not exist\n");
       return;
     }
@@ -276,15 +524,23 @@ class Undirected : public Ctx {
       std::printf("Error: Missing argument\n");
       return;
     }
-    if (token.compare("list"sv) == 0)
-      detail::Print(*mst::Kruskal<AdjacencyList>(g_list_));
-    else if (token.compare("matrix"sv) == 0)
-      detail::Print(*mst::Kruskal<AdjacencyMatrix>(g_matrix_));
-    else
+    const auto* permutation = graphs_.Permutation();
+    const auto print = [this, permutation](std::unique_ptr<SpanningTree> spanning_tree) {
+      if (permutation != nullptr) reorder::Restore(*spanning_tree, *permutation);
+      Output(*spanning_tree, ids_.get());
+    };
+    if (token.compare("list"sv) == 0) {
+      if (const auto g_list = graphs_.List(); g_list != nullptr)
+        Run([&](auto& instr) { return mst::Kruskal<UndirectedList>(g_list, instr); }, print);
+    } else if (token.compare("matrix"sv) == 0) {
+      if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+        Run([&](auto& instr) { return mst::Kruskal<UndirectedMatrix>(g_matrix, instr); }, print);
+    } else {
       std::printf("Error: Invalid graph representaton\n");
+    }
   }
   void Prim(std::string_view line) const {
-    if (g_list_ == nullptr || g_matrix_ == nullptr) {
+    if (graphs_.Empty()) {
       std::printf("Error: Graph does not exist\n");
       return;
     }
@@ -293,12 +549,37 @@ class Undirected : public Ctx {
       std::printf("Error: Missing argument\n");
       return;
     }
-    if (token.compare("list"sv) == 0)
-      detail::Print(*mst::Prim<AdjacencyList>(g_list_));
-    else if (token.compare("matrix"sv) == 0)
-      detail::Print(*mst::Prim<AdjacencyMatrix>(g_matrix_));
-    else
+    const auto* permutation = graphs_.Permutation();
+    const auto print = [this, permutation](std::unique_ptr<SpanningTree> spanning_tree) {
+      if (permutation != nullptr) reorder::Restore(*spanning_tree, *permutation);
+      Output(*spanning_tree, ids_.get());
+    };
+    if (token.compare("list"sv) == 0) {
+      if (const auto g_list = graphs_.List(); g_list != nullptr)
+        Run([&](auto& instr) { return mst::Prim<UndirectedList>(g_list, instr); }, print);
+    } else if (token.compare("matrix"sv) == 0) {
+      if (const auto g_matrix = graphs_.Matrix(); g_matrix != nullptr)
+        Run([&](auto& instr) { return mst::Prim<UndirectedMatrix>(g_matrix, instr); }, print);
+    } else {
       std::printf("Error: Invalid graph representaton\n");
+    }
+  }
+
+  // Relabel the graph for locality, the results are still reported with the
+  // original ids. The list and matrix commands print the relabelled graph.
+  void Reorder(std::string_view line) {
+    if (graphs_.Empty()) {
+      std::printf("Error: Graph does not exist\n");
+      return;
+    }
+    std::string_view token;
+    if (!GetToken(line, token, "ordering")) return;
+    reorder::Ordering ordering;
+    if (!ParseOrdering(token, ordering)) {
+      std::printf("Error: Invalid ordering, should be none, bfs, degree or rcm\n");
+      return;
+    }
+    graphs_.Reorder(ordering);
   }
 
   void GenerateGraph(std::string_view line) {
@@ -317,18 +598,50 @@ class Undirected : public Ctx {
       std::printf("Error: Invalid density, should be 0 < density <= 100\n");
       return;
     }
-    std::vector<WEdge> edges = graph_gen_.Generate(vertices, density, false);
-    Load(edges, vertices);
+    Load(std::make_shared<const std::vector<WEdge>>(graph_gen_.Generate(vertices, density, false)), vertices);
   }
 
-  std::shared_ptr<AdjacencyList> g_list_{nullptr};
-  std::shared_ptr<AdjacencyMatrix> g_matrix_{nullptr};
+  Representations<UndirectedList, UndirectedMatrix> graphs_{&interrupt};
+  // Labels of the vertices of a compacted input, nullptr if they are the ids.
+  std::shared_ptr<const IdMap> ids_;
   GraphGenerator graph_gen_{true};
 };
 
+// Edge set of the input, parsed once on its first use and shared by the
+// contexts entered afterwards.
+class Session {
+ public:
+  Session(const char* input, const bool compact_ids) : input_(input), compact_ids_(compact_ids) {}
+
+  // Parse the input unless already done, false on a failure.
+  bool Load() {
+    if (edges_ != nullptr) return true;
+    auto edges = std::make_shared<std::vector<WEdge>>();
+    auto ids = compact_ids_ ? std::make_shared<IdMap>() : nullptr;
+    if (!LoadGraph(*edges, vertices_, input_, &vb_, ids.get())) return false;
+    edges_ = std::move(edges);
+    ids_ = std::move(ids);
+    return true;
+  }
+
+  std::shared_ptr<const std::vector<WEdge>> Edges() const { return edges_; }
+  size_t VerticesNo() const { return vertices_; }
+  Vertex Start() const { return vb_; }
+  std::shared_ptr<const IdMap> Ids() const { return ids_; }
+
+ private:
+  const char* input_;
+  bool compact_ids_;
+  std::shared_ptr<const std::vector<WEdge>> edges_;
+  size_t vertices_{0};
+  Vertex vb_{0};
+  std::shared_ptr<const IdMap> ids_;
+};
+
 class Main : public Ctx {
  public:
-  Main(CtxPtr* ctx, const char* input) : input_(input), ctx_ref_(ctx) {
+  Main(CtxPtr* ctx, const char* input, const bool compact_ids)
+      : session_(input, compact_ids), input_(input), ctx_ref_(ctx) {
     cmds_["directed"] = std::make_pair("[init]", std::bind(&Main::EnterDirected, this, _1));
     cmds_["undirected"] = std::make_pair("[init]", std::bind(&Main::EnterUndirected, this, _1));
   }
@@ -337,41 +650,33 @@ class Main : public Ctx {
 
  private:
   void EnterDirected(std::string_view line) {
-    std::shared_ptr<Directed> ctx_undirected = std::make_shared<Directed>();
-    *ctx_ref_ = ctx_undirected;
-    std::string_view token;
-    if (!GetToken(line, token) || token.compare("init"sv) != 0) return;
-    if (input_ == nullptr) {
-      std::printf("Error: No --input provided\n");
-      return;
-    }
-    std::vector<WEdge> edges;
-    size_t vertices;
-    Vertex vb;
-    if (!LoadGraph(edges, vertices, input_, &vb)) {
-      std::printf("Error: Loading graph\n");
-      return;
-    }
-    ctx_undirected->Load(edges, vertices, vb);
+    std::shared_ptr<Directed> ctx_directed = std::make_shared<Directed>();
+    *ctx_ref_ = ctx_directed;
+    if (!Init(line)) return;
+    ctx_directed->Load(session_.Edges(), session_.VerticesNo(), session_.Start(), session_.Ids());
   }
   void EnterUndirected(std::string_view line) {
     std::shared_ptr<Undirected> ctx_undirected = std::make_shared<Undirected>();
     *ctx_ref_ = ctx_undirected;
+    if (!Init(line)) return;
+    ctx_undirected->Load(session_.Edges(), session_.VerticesNo(), session_.Ids());
+  }
+  // Whether `line` asks for the input graph and it is loaded.
+  bool Init(std::string_view line) {
     std::string_view token;
-    if (!GetToken(line, token) || token.compare("init"sv) != 0) return;
+    if (!GetToken(line, token) || token.compare("init"sv) != 0) return false;
     if (input_ == nullptr) {
       std::printf("Error: No --input provided\n");
-      return;
+      return false;
     }
-    std::vector<WEdge> edges;
-    size_t vertices;
-    if (!LoadGraph(edges, vertices, input_)) {
+    if (!session_.Load()) {
       std::printf("Error: Loading graph\n");
-      return;
+      return false;
     }
-    ctx_undirected->Load(edges, vertices);
+    return true;
   }
 
+  Session session_;
   const char* input_{nullptr};
 
   CtxPtr* ctx_ref_{nullptr};
@@ -379,13 +684,386 @@ class Main : public Ctx {
 
 }  // namespace menu
 
+// Non-interactive replay of a trace of menu commands. Every command of the
+// trace is answered by one line "<line number> ok [result]" or
+// "<line number> err <reason>", the results being:
+//   dijkstra, bellmanford   the distances of the vertices in order of their ids,
+//                           `inf` if unreachable, <label>:<distance> pairs with
+//                           --compact-ids as in the server
+//   kruskal, prim           the cost and the u v w of every tree edge
+// followed by the counters as name=value if enabled. Consecutive read-only
+// commands, the queries, do not depend on each other and run in parallel.
+namespace batch {
+
+using std::operator""sv;
+using menu::GetToken;
+using menu::ParseNum;
+using menu::ParseOrdering;
+using output::Append;
+
+void AppendCounters(std::string& out, const instrument::Counters& counters) {
+  const std::pair<const char*, uint64_t> fields[] = {
+      {" edge_scans=", counters.edge_scans},     {" relaxations=", counters.relaxations},
+      {" heap_pushes=", counters.heap_pushes},   {" heap_pops=", counters.heap_pops},
+      {" decrease_keys=", counters.decrease_keys}, {" stale_skips=", counters.stale_skips},
+      {" rounds=", counters.rounds},             {" finds=", counters.finds},
+      {" unions=", counters.unions},
+  };
+  for (const auto& [name, value] : fields) {
+    out += name;
+    Append(out, value);
+  }
+}
+
+class Replay {
+  enum class Context { kMain, kDirected, kUndirected };
+
+  // Read-only command, answered on any thread.
+  struct Query {
+    size_t line_no;
+    std::string line;
+    std::string out;
+  };
+
+ public:
+  Replay(const char* input, const bool compact_ids, const bool random, const size_t threads)
+      : input_(input), threads_(threads), session_(input, compact_ids), graph_gen_(random) {}
+
+  // Replay the trace of `fp`, line by line, until its end or the exit of the
+  // main context.
+  void Run(FILE* fp) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t linecap = 0;
+    char* line = nullptr;
+    ssize_t linelen;
+    for (size_t line_no = 1; (linelen = ::getline(&line, &linecap, fp)) > 0; ++line_no) {
+      std::string command(line, linelen);
+      while (!command.empty() && (command.back() == '\n' || command.back() == '\r')) command.pop_back();
+      if (command.empty() || command.front() == '#') continue;
+      ++commands_;
+      // The tokens of the menu are terminated by spaces.
+      command += ' ';
+      if (!Execute(line_no, std::move(command))) break;
+    }
+    std::free(line);
+    Flush();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fflush(stdout);
+    std::fprintf(stderr,
+                 "Replayed %zu commands, %zu queries, in %.3f s: %.1f commands/s, %.1f queries/s, threads= %zu\n",
+                 commands_, queries_, seconds, commands_ / seconds, queries_ / seconds, threads_);
+  }
+
+ private:
+  // Run a command changing the state, after the queries before it, or queue a
+  // query. Return false on the exit of the main context.
+  bool Execute(const size_t line_no, std::string command) {
+    std::string_view line(command), name;
+    GetToken(line, name);
+    const bool query = context_ == Context::kDirected ? name == "dijkstra"sv || name == "bellmanford"sv
+                       : context_ == Context::kUndirected ? name == "kruskal"sv || name == "prim"sv
+                                                          : false;
+    if (query) {
+      ++queries_;
+      pending_.push_back(Query{line_no, std::move(command), std::string()});
+      return true;
+    }
+    Flush();
+    std::string out;
+    Append(out, line_no);
+    const bool more = Change(name, line, out);
+    out += '\n';
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return more;
+  }
+
+  // Answer the pending queries and print their results in the trace order.
+  void Flush() {
+    Prepare();
+    parallel::For(threads_, pending_.size(), [this](size_t, const size_t begin, const size_t end) {
+      for (size_t i = begin; i < end; ++i) Answer(pending_[i]);
+    });
+    for (const Query& query : pending_) std::fwrite(query.out.data(), 1, query.out.size(), stdout);
+    pending_.clear();
+  }
+
+  // Build the representations asked for by the pending queries, the threads
+  // answering them then only read the built graphs.
+  void Prepare() const {
+    for (const Query& query : pending_) {
+      std::string_view line(query.line), name, representation;
+      GetToken(line, name);
+      if (!GetToken(line, representation)) continue;
+      if (context_ == Context::kDirected)
+        Build(directed_, representation);
+      else
+        Build(undirected_, representation);
+    }
+  }
+  template <typename Graphs>
+  static void Build(const Graphs& graphs, const std::string_view representation) {
+    if (graphs.Empty()) return;
+    if (representation == "list"sv)
+      graphs.List();
+    else if (representation == "matrix"sv)
+      graphs.Matrix(true);
+  }
+
+  bool Change(const std::string_view name, std::string_view line, std::string& out) {
+    std::string_view token;
+    if (name == "exit"sv) {
+      if (context_ == Context::kMain) {
+        out += " ok";
+        return false;
+      }
+      context_ = Context::kMain;
+      out += " ok";
+      return true;
+    }
+    if (name == "counters"sv) {
+      if (GetToken(line, token) && (token == "on"sv || token == "off"sv)) {
+        counters_ = token == "on"sv;
+        out += " ok";
+      } else {
+        out += " err invalid argument";
+      }
+      return true;
+    }
+    if (context_ == Context::kMain && (name == "directed"sv || name == "undirected"sv)) {
+      context_ = name == "directed"sv ? Context::kDirected : Context::kUndirected;
+      directed_.Load(nullptr, 0);
+      undirected_.Load(nullptr, 0);
+      ids_.reset();
+      if (!GetToken(line, token) || token != "init"sv) {
+        out += " ok";
+        return true;
+      }
+      if (input_ == nullptr || !session_.Load()) {
+        out += " err loading graph";
+        return true;
+      }
+      ids_ = session_.Ids();
+      vb_ = session_.Start();
+      Load(session_.Edges(), session_.VerticesNo());
+      out += " ok";
+      return true;
+    }
+    if (context_ != Context::kMain && name == "generate"sv) {
+      long vertices;
+      int density;
+      if (!GetToken(line, token) || !ParseNum(token, vertices) || vertices < 1) {
+        out += " err invalid number of vertices";
+        return true;
+      }
+      if (!GetToken(line, token) || !ParseNum(token, density) || density < 1 || density > 100) {
+        out += " err invalid density";
+        return true;
+      }
+      const bool directed = context_ == Context::kDirected;
+      ids_.reset();
+      Load(std::make_shared<const std::vector<WEdge>>(
+               graph_gen_.Generate(vertices, density, directed, directed ? &vb_ : nullptr)),
+           vertices);
+      out += " ok";
+      return true;
+    }
+    if (context_ != Context::kMain && name == "reorder"sv) {
+      reorder::Ordering ordering;
+      if (!GetToken(line, token) || !ParseOrdering(token, ordering)) {
+        out += " err invalid ordering";
+        return true;
+      }
+      if (!Reorder(ordering)) {
+        out += " err graph does not exist";
+        return true;
+      }
+      out += " ok";
+      return true;
+    }
+    if (name == "list"sv || name == "matrix"sv || name == "help"sv)
+      out += " err not supported in batch mode";
+    else
+      out += " err unknown command";
+    return true;
+  }
+
+  // Load the graph of the current context, its representations are built on
+  // their first use.
+  void Load(std::shared_ptr<const std::vector<WEdge>> edges, const size_t vertices) {
+    if (context_ == Context::kDirected)
+      directed_.Load(std::move(edges), vertices);
+    else
+      undirected_.Load(std::move(edges), vertices);
+  }
+
+  bool Reorder(const reorder::Ordering ordering) {
+    if (context_ == Context::kDirected) {
+      if (directed_.Empty()) return false;
+      directed_.Reorder(ordering);
+    } else {
+      if (undirected_.Empty()) return false;
+      undirected_.Reorder(ordering);
+    }
+    return true;
+  }
+
+  // Run `fn` with the instrumentation selected by the counters command, the
+  // counters are appended to `suffix`.
+  template <typename Fn>
+  auto Counted(Fn fn, std::string& suffix) const {
+    if (!counters_) {
+      instrument::Disabled instr;
+      return fn(instr);
+    }
+    instrument::Enabled instr;
+    auto result = fn(instr);
+    AppendCounters(suffix, instr);
+    return result;
+  }
+
+  void Answer(Query& query) const {
+    std::string& out = query.out;
+    Append(out, query.line_no);
+    std::string_view line(query.line), name, representation;
+    GetToken(line, name);
+    if (!GetToken(line, representation) || (representation != "list"sv && representation != "matrix"sv)) {
+      out += " err invalid graph representation\n";
+      return;
+    }
+    const bool list = representation == "list"sv;
+    std::string counters;
+    if (context_ == Context::kDirected) {
+      if (directed_.Empty()) {
+        out += " err graph does not exist\n";
+        return;
+      }
+      Vertex vb = vb_;
+      if (!ParseStart(line, vb)) {
+        out += " err invalid start vertex\n";
+        return;
+      }
+      const auto g_list = list ? directed_.List() : nullptr;
+      const auto g_matrix = list ? nullptr : directed_.Matrix(true);
+      if (!list && g_matrix == nullptr) {
+        out += " err matrix too large\n";
+        return;
+      }
+      const auto* permutation = directed_.Permutation();
+      const Vertex vr = permutation != nullptr ? permutation->to_new[vb] : vb;
+      std::unique_ptr<PathCost> path_cost;
+      if (name == "dijkstra"sv)
+        path_cost = Counted(
+            [&](auto& instr) {
+              return list ? shortestpath::Dijkstra<DirectedList>(g_list, vr, instr)
+                          : shortestpath::Dijkstra<DirectedMatrix>(g_matrix, vr, instr);
+            },
+            counters);
+      else
+        path_cost = Counted(
+            [&](auto& instr) {
+              return list ? shortestpath::BellmanFord<DirectedList>(g_list, vr, instr)
+                          : shortestpath::BellmanFord<DirectedMatrix>(g_matrix, vr, instr);
+            },
+            counters);
+      if (!path_cost) {
+        out += " err negative cycle\n";
+        return;
+      }
+      if (permutation != nullptr) reorder::Restore(*path_cost, *permutation);
+      out += " ok";
+      const auto& distances = path_cost->second;
+      for (size_t v = 0; v < distances.size(); ++v) {
+        out += ' ';
+        if (ids_ != nullptr) {
+          Append(out, ids_->Label(v));
+          out += ':';
+        }
+        if (distances[v] == shortestpath::kDistanceInf<Graph<DirectedList>::Distance>)
+          out += "inf";
+        else
+          Append(out, distances[v]);
+      }
+    } else {
+      if (undirected_.Empty()) {
+        out += " err graph does not exist\n";
+        return;
+      }
+      const auto g_list = list ? undirected_.List() : nullptr;
+      const auto g_matrix = list ? nullptr : undirected_.Matrix(true);
+      if (!list && g_matrix == nullptr) {
+        out += " err matrix too large\n";
+        return;
+      }
+      const auto spanning_tree = Counted(
+          [&](auto& instr) {
+            if (name == "kruskal"sv)
+              return list ? mst::Kruskal<UndirectedList>(g_list, instr)
+                          : mst::Kruskal<UndirectedMatrix>(g_matrix, instr);
+            return list ? mst::Prim<UndirectedList>(g_list, instr) : mst::Prim<UndirectedMatrix>(g_matrix, instr);
+          },
+          counters);
+      if (const auto* permutation = undirected_.Permutation(); permutation != nullptr)
+        reorder::Restore(*spanning_tree, *permutation);
+      out += " ok ";
+      Append(out, detail::SpanningTreeCost(*spanning_tree));
+      for (const auto& [edge, weight] : *spanning_tree) {
+        out += ' ';
+        Append(out, Label(edge.first));
+        out += ' ';
+        Append(out, Label(edge.second));
+        out += ' ';
+        Append(out, weight);
+      }
+    }
+    out += counters;
+    out += '\n';
+  }
+
+  // Parse the optional start vertex, a label of a compacted input.
+  bool ParseStart(std::string_view line, Vertex& vb) const {
+    std::string_view token;
+    uint64_t vstart;
+    if (!GetToken(line, token)) return true;
+    if (!ParseNum(token, vstart)) return false;
+    if (ids_ != nullptr) return ids_->Find(vstart, vb);
+    vb = vstart;
+    return vb < directed_.VerticesNo();
+  }
+
+  uint64_t Label(const Vertex v) const { return ids_ != nullptr ? ids_->Label(v) : v; }
+
+  const char* input_;
+  const size_t threads_;
+  // The input, parsed on the first init.
+  menu::Session session_;
+  GraphGenerator graph_gen_;
+  Context context_{Context::kMain};
+  bool counters_{false};
+  std::vector<Query> pending_;
+  size_t commands_{0};
+  size_t queries_{0};
+
+  menu::Representations<DirectedList, DirectedMatrix> directed_;
+  menu::Representations<UndirectedList, UndirectedMatrix> undirected_;
+  std::shared_ptr<const IdMap> ids_;
+  Vertex vb_{0};
+};
+}  // namespace batch
+
 }  // namespace
 
 bool Functional(const util::Args& args) {
   std::shared_ptr<menu::Ctx> ctx{nullptr};
-  std::shared_ptr<menu::Ctx> ctx_main = std::make_shared<menu::Main>(&ctx, args.GetValue("input"));
+  std::shared_ptr<menu::Ctx> ctx_main =
+      std::make_shared<menu::Main>(&ctx, args.GetValue("input"), args.IsFlag("compact-ids"));
   ctx = ctx_main;
 
+  // SIGINT interrupts the running command, at the prompt it ends the getline()
+  // below, without SA_RESTART, and so the menu.
+  struct sigaction action {};
+  action.sa_handler = Interrupt;
+  ::sigaction(SIGINT, &action, nullptr);
+
   size_t linecap = 1024;
   char* line = static_cast<char*>(std::malloc(1024));
   if (line == nullptr) return false;
@@ -401,6 +1079,8 @@ bool Functional(const util::Args& args) {
       continue;
     }
     line[linelen - 1] = ' ';
+    // A SIGINT from now on interrupts this command, the graph builds included.
+    interrupt.Reset();
     if (!ctx->Handle(std::string_view(line, linelen))) break;
   }
 
@@ -408,4 +1088,21 @@ bool Functional(const util::Args& args) {
   return true;
 }
 
+bool Batch(const util::Args& args) {
+  FILE* fp = std::fopen(args.GetValue("batch"), "r");
+  if (fp == nullptr) {
+    std::fprintf(stderr, "Error: Cannot open %s\n", args.GetValue("batch"));
+    return false;
+  }
+  size_t threads = 1;
+  if (const char* value = args.GetValue("threads"); value != nullptr) {
+    char* end;
+    const unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (*end == '\0' && parsed > 0) threads = parsed;
+  }
+  batch::Replay(args.GetValue("input"), args.IsFlag("compact-ids"), args.IsFlag("random"), threads).Run(fp);
+  std::fclose(fp);
+  return true;
+}
+
 }  // namespace sdizo::test
@@ -0,0 +1,117 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Export of a generated graph to the input format, so that large inputs are
+// generated once and shared between machines and runs.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "graphgenerator.hpp"
+#include "graphtype.hpp"
+#include "graphwriter.hpp"
+#include "test.hpp"
+
+namespace sdizo::test {
+
+namespace {
+
+namespace config {
+
+// Densities up to this one draw the edges at random instead of enumerating all
+// vertex pairs, which does not fit the memory past a few ten thousand vertices.
+constexpr double kSparseDensity = 10;
+
+}  // namespace config
+
+using Clock = std::chrono::steady_clock;
+
+bool ParsePositive(const char* value, size_t& parsed) {
+  char* end;
+  parsed = std::strtoull(value, &end, 10);
+  return *end == '\0' && parsed > 0;
+}
+bool ParsePositive(const char* value, double& parsed) {
+  char* end;
+  parsed = std::strtod(value, &end);
+  return *end == '\0' && parsed > 0;
+}
+
+}  // namespace
+
+bool Generate(const util::Args& args) {
+  const std::vector<const char*> values = args.GetValues("generate");
+  size_t vertices;
+  double density;
+  if (values.size() != 2 || !ParsePositive(values[0], vertices) || !ParsePositive(values[1], density) ||
+      density > 100 || vertices < 2) {
+    std::fprintf(stderr, "Error: Expected --generate <vertices> <density>, 1 < vertices, 0 < density <= 100\n");
+    return false;
+  }
+  const char* output = args.GetValue("output");
+  if (output == nullptr) {
+    std::fprintf(stderr, "Error: No --output provided\n");
+    return false;
+  }
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  if (const char* value = args.GetValue("threads"); value != nullptr && !ParsePositive(value, threads)) {
+    std::fprintf(stderr, "Error: Invalid number of threads\n");
+    return false;
+  }
+  const bool directed = !args.IsFlag("undirected");
+
+  const size_t pairs = (vertices * vertices - vertices) / (directed ? 1 : 2);
+  GraphGenerator graph_gen(args.IsFlag("random"));
+  Vertex vb = 0;
+  std::vector<WEdge> edges;
+  const Clock::time_point start = Clock::now();
+  // The dense generator holds every vertex pair, the sparse one only the edges.
+  const bool sparse = density <= config::kSparseDensity;
+  const size_t edges_no = pairs * density / 100;
+  const size_t bytes = (sparse ? edges_no : pairs) * sizeof(WEdge);
+  if (const size_t memory = PhysicalMemory(); memory != 0 && bytes > memory) {
+    std::fprintf(stderr, "Error: Generating the graph needs %.1f MB, the machine has %.1f MB\n", bytes / 1e6,
+                 memory / 1e6);
+    return false;
+  }
+  if (sparse) {
+    const size_t degree = (2 * edges_no + vertices - 1) / vertices;
+    edges = graph_gen.GenerateSparse(vertices, degree, directed, &vb);
+  } else {
+    edges = graph_gen.Generate(vertices, static_cast<size_t>(density), directed, &vb);
+  }
+  const Clock::time_point generated = Clock::now();
+
+  GraphWriter writer;
+  writer.Threads(threads);
+  if (!writer.Open(output)) return false;
+  if (!writer.Write(edges, vertices, vb, vertices - 1) || !writer.Close()) {
+    std::fprintf(stderr, "Error: Writing %s\n", output);
+    return false;
+  }
+  const Clock::time_point written = Clock::now();
+  const double generate_s = std::chrono::duration<double>(generated - start).count();
+  const double write_s = std::chrono::duration<double>(written - generated).count();
+  std::printf("Generated %zu edges of %zu vertices in %.2f s, written to %s in %.2f s (%.1f Medges/s)\n", edges.size(),
+              vertices, generate_s, output, write_s, edges.size() / write_s / 1e6);
+  return true;
+}
+
+}  // namespace sdizo::test
@@ -16,36 +16,116 @@
 
 #include "graph.hpp"
 
-#include <cstdio>
-#include <list>
-#include <numeric>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
-namespace sdizo::detail {
+#include "idmap.hpp"
 
-void Print(const SpanningTree& st) {
-  std::printf("Spanning tree cost: %d\n", SpanningTreeCost(st));
-  for (const auto& [edge, weight] : st) std::printf("[%2zu]--(%3d)--[%2zu]\n", edge.first, weight, edge.second);
-}
+namespace sdizo {
+
+namespace detail {
 
-Weight SpanningTreeCost(const SpanningTree& st) {
-  return std::accumulate(st.begin(), st.end(), 0,
-                         [](const Weight cost, const WEdge& wedge) -> Weight { return cost + wedge.second; });
+template <typename V, typename W>
+void Print(const std::pmr::set<std::pair<std::pair<V, V>, W>>& st, const IdMap* ids) {
+  const auto label = [ids](const V v) -> uint64_t { return ids != nullptr ? ids->Label(v) : v; };
+  output::Writer out;
+  out.Text("Spanning tree cost: ").Number(static_cast<int64_t>(SpanningTreeCost(st))).Char('\n');
+  for (const auto& [edge, weight] : st) {
+    out.Char('[').Number(label(edge.first), 2).Text("]--(").Number(static_cast<int64_t>(weight), 3);
+    out.Text(")--[").Number(label(edge.second), 2).Text("]\n");
+  }
 }
 
-void Print(const Vertex vb, const PathCost& path_cost) {
+template <typename V, typename D>
+void Print(const size_t vb, const std::pair<std::pmr::vector<V>, std::pmr::vector<D>>& path_cost, const IdMap* ids,
+           const PathFormat format) {
+  constexpr D kInf = std::numeric_limits<D>::max();
+  const auto label = [ids](const size_t v) -> uint64_t { return ids != nullptr ? ids->Label(v) : v; };
   const auto& predecessors = path_cost.first;
   const auto& distances = path_cost.second;
+  output::Writer out;
+  if (format == PathFormat::kParents) {
+    for (size_t i = 0; i < predecessors.size(); ++i) {
+      out.Number(label(i));
+      if (i == vb || distances[i] == kInf)
+        out.Text(" -");
+      else
+        out.Char(' ').Number(label(predecessors[i]));
+      if (distances[i] == kInf)
+        out.Text(" inf\n");
+      else
+        out.Char(' ').Number(static_cast<int64_t>(distances[i])).Char('\n');
+    }
+    return;
+  }
+  // The path of a vertex, from it back to the start, reused by every vertex.
+  std::vector<size_t> path;
   for (size_t i = 0; i < predecessors.size(); ++i) {
+    out.Char('[').Number(label(vb), 2).Text("]-(");
+    if (distances[i] == kInf) {
+      // Unreachable, its predecessor is not set.
+      out.Text("inf)->[").Number(label(i), 2).Text("]\n");
+      continue;
+    }
+    out.Number(static_cast<int64_t>(distances[i]), 3).Text(")->[").Number(label(i), 2).Char(']');
     if (i == vb) {
-      std::printf("[%2zu]-(%3d)->[%2zu]\n", i, distances[i], i);
+      out.Char('\n');
       continue;
     }
-    std::list<Vertex> path;
-    for (Vertex v = i; v != vb; v = predecessors[v]) path.push_front(v);
-    std::printf("[%2zu]-(%3d)->[%2zu]: [%2zu]", vb, distances[i], i, vb);
-    for (const Vertex& w : path) std::printf("->[%2zu]", w);
-    std::putchar('\n');
+    path.clear();
+    for (size_t v = i; v != vb; v = predecessors[v]) path.push_back(v);
+    out.Text(": [").Number(label(vb), 2).Char(']');
+    for (auto it = path.crbegin(); it != path.crend(); ++it) out.Text("->[").Number(label(*it), 2).Char(']');
+    out.Char('\n');
   }
 }
 
-}  // namespace sdizo::detail
+template <typename V, typename W>
+void Write(output::Writer& out, const std::pmr::set<std::pair<std::pair<V, V>, W>>& st, const IdMap* ids) {
+  const auto label = [ids](const V v) -> uint64_t { return ids != nullptr ? ids->Label(v) : v; };
+  out.Text("SDZT").Raw(uint64_t{st.size()}).Raw(static_cast<int64_t>(SpanningTreeCost(st)));
+  for (const auto& [edge, weight] : st)
+    out.Raw(label(edge.first)).Raw(label(edge.second)).Raw(static_cast<int64_t>(weight));
+}
+
+template <typename V, typename D>
+void Write(output::Writer& out, const size_t vb, const std::pair<std::pmr::vector<V>, std::pmr::vector<D>>& path_cost,
+           const IdMap* ids) {
+  constexpr D kInf = std::numeric_limits<D>::max();
+  const auto label = [ids](const size_t v) -> uint64_t { return ids != nullptr ? ids->Label(v) : v; };
+  const auto& predecessors = path_cost.first;
+  const auto& distances = path_cost.second;
+  out.Text("SDZP").Raw(uint64_t{predecessors.size()}).Raw(label(vb));
+  for (size_t i = 0; i < predecessors.size(); ++i)
+    out.Raw(i == vb || distances[i] == kInf ? UINT64_MAX : label(predecessors[i]));
+  for (const D distance : distances) out.Raw(distance == kInf ? INT64_MAX : static_cast<int64_t>(distance));
+}
+
+#define SDIZO_INSTANTIATE_PRINT(V, W)                                       \
+  template void Print(const GraphTypes<V, W>::SpanningTree&, const IdMap*); \
+  template void Write(output::Writer&, const GraphTypes<V, W>::SpanningTree&, const IdMap*);
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_INSTANTIATE_PRINT)
+#undef SDIZO_INSTANTIATE_PRINT
+
+// 16-bit weights sum up as 32-bit distances, so (uint32_t, int16_t) shares the
+// path cost type of (uint32_t, int32_t).
+#define SDIZO_INSTANTIATE_PRINT(V, W)                                                       \
+  template void Print(size_t, const GraphTypes<V, W>::PathCost&, const IdMap*, PathFormat); \
+  template void Write(output::Writer&, size_t, const GraphTypes<V, W>::PathCost&, const IdMap*);
+SDIZO_INSTANTIATE_PRINT(size_t, int32_t)
+SDIZO_INSTANTIATE_PRINT(uint32_t, int32_t)
+SDIZO_INSTANTIATE_PRINT(uint32_t, int64_t)
+#undef SDIZO_INSTANTIATE_PRINT
+
+}  // namespace detail
+
+#define SDIZO_INSTANTIATE_GRAPHS(V, W)         \
+  template class AdjacencyMatrix<true, V, W>;  \
+  template class AdjacencyMatrix<false, V, W>; \
+  template class AdjacencyList<true, V, W>;    \
+  template class AdjacencyList<false, V, W>;
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_INSTANTIATE_GRAPHS)
+#undef SDIZO_INSTANTIATE_GRAPHS
+
+}  // namespace sdizo
@@ -17,116 +17,399 @@
 #ifndef SDIZO_GRAPH_HPP_
 #define SDIZO_GRAPH_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
 #include <set>
+#include <type_traits>
 #include <vector>
 
+#include "bulkload.hpp"
 #include "graphtype.hpp"
+#include "output.hpp"
+#include "parallel.hpp"
 
 namespace sdizo {
 
-using Connection = std::pair<Vertex, Weight>;
-using Connections = std::list<Connection>;
-using Adjacent = std::vector<Connections>;
+class IdMap;
 
-using SpanningTree = std::set<WEdge>;
-using PathCost = std::pair<std::vector<Vertex>, std::vector<Weight>>;
+// Shortest paths printed as the path to every vertex, or as the parent array of
+// their tree, one "<vertex> <parent> <distance>" line per vertex.
+enum class PathFormat { kPaths, kParents };
 
 namespace detail {
 
-void Print(const SpanningTree& st);
-void Print(const Vertex vb, const PathCost& path_cost);
-Weight SpanningTreeCost(const SpanningTree& st);
+// Defined for the types of SDIZO_FOR_EACH_GRAPH_TYPES, the path cost one for
+// their distinct (vertex, distance) pairs. The vertices are printed as their
+// labels in `ids`, if given.
+template <typename V, typename W>
+void Print(const std::pmr::set<std::pair<std::pair<V, V>, W>>& st, const IdMap* ids = nullptr);
+template <typename V, typename D>
+void Print(size_t vb, const std::pair<std::pmr::vector<V>, std::pmr::vector<D>>& path_cost,
+           const IdMap* ids = nullptr, PathFormat format = PathFormat::kPaths);
+
+// Binary results, every number 64-bit in the byte order of the machine:
+//   path cost       "SDZP" vertices vstart parent[vertices] distance[vertices],
+//                   the parent of the start and of an unreachable vertex being
+//                   UINT64_MAX and the distance of the latter INT64_MAX
+//   spanning tree   "SDZT" edges cost (u v weight)[edges]
+template <typename V, typename W>
+void Write(output::Writer& out, const std::pmr::set<std::pair<std::pair<V, V>, W>>& st, const IdMap* ids = nullptr);
+template <typename V, typename D>
+void Write(output::Writer& out, size_t vb, const std::pair<std::pmr::vector<V>, std::pmr::vector<D>>& path_cost,
+           const IdMap* ids = nullptr);
+
+template <typename V, typename W>
+typename GraphTypes<V, W>::Distance SpanningTreeCost(const std::pmr::set<std::pair<std::pair<V, V>, W>>& st) {
+  using Distance = typename GraphTypes<V, W>::Distance;
+  return std::accumulate(st.begin(), st.end(), Distance{0},
+                         [](const Distance cost, const auto& wedge) -> Distance { return cost + wedge.second; });
+}
 
 }  // namespace detail
 
+// GraphTypes of a representation, specialized by every representation, so that
+// Graph can name them before the representation is complete.
+template <class GRepr>
+struct GraphTraits;
+
 template <class GRepr>
 class Graph {
  public:
+  using Vertex = typename GraphTraits<GRepr>::Vertex;
+  using Weight = typename GraphTraits<GRepr>::Weight;
+  using Distance = typename GraphTraits<GRepr>::Distance;
+  using Edge = typename GraphTraits<GRepr>::Edge;
+  using WEdge = typename GraphTraits<GRepr>::WEdge;
+  using EdgeArrays = typename GraphTraits<GRepr>::EdgeArrays;
+  using Connection = typename GraphTraits<GRepr>::Connection;
+  using Connections = typename GraphTraits<GRepr>::Connections;
+  using Adjacent = typename GraphTraits<GRepr>::Adjacent;
+  using SpanningTree = typename GraphTraits<GRepr>::SpanningTree;
+  using PathCost = typename GraphTraits<GRepr>::PathCost;
+
   std::shared_ptr<const Adjacent> Adj() const { return static_cast<GRepr const*>(this)->Adj(); }
+  // Call fn(v, weight) for every arc (u, v), without materializing Adj().
+  template <typename Fn>
+  void ForEachNeighbour(Vertex u, Fn fn) const {
+    static_cast<GRepr const*>(this)->ForEachNeighbour(u, fn);
+  }
+  // As ForEachNeighbour(), but stop at the first arc for which fn(v, weight)
+  // returns false.
+  template <typename Fn>
+  void ForEachNeighbourWhile(Vertex u, Fn fn) const {
+    static_cast<GRepr const*>(this)->ForEachNeighbourWhile(u, fn);
+  }
   std::unique_ptr<std::vector<WEdge>> Edges() const { return static_cast<GRepr const*>(this)->Edges(); }
+  // Arcs as separate arrays grouped by the target vertex, see EdgeArrays.
+  std::unique_ptr<EdgeArrays> EdgesByTarget() const { return static_cast<GRepr const*>(this)->EdgesByTarget(); }
   void Print() const { static_cast<GRepr const*>(this)->Print(); }
   std::unique_ptr<std::set<Vertex>> Vertices() const { return static_cast<GRepr const*>(this)->Vertices(); }
   size_t VerticesNo() const { return static_cast<GRepr const*>(this)->VerticesNo(); }
+  // Memory resource backing the graph storage.
+  std::pmr::memory_resource* Resource() const { return static_cast<GRepr const*>(this)->Resource(); }
 
   void AddEdge(Vertex vb, Vertex ve, Weight w) { static_cast<GRepr*>(this)->AddEdge(vb, ve, w); }
+  // Remove the edge (vb, ve), return false if there is none.
+  bool RemoveEdge(Vertex vb, Vertex ve) { return static_cast<GRepr*>(this)->RemoveEdge(vb, ve); }
+  // Set the weight of the edge (vb, ve), return false if there is none.
+  bool UpdateWeight(Vertex vb, Vertex ve, Weight w) { return static_cast<GRepr*>(this)->UpdateWeight(vb, ve, w); }
+  bool AddEdges(const std::vector<WEdge>& edges, Duplicates policy = Duplicates::kKeep, size_t threads = 1) {
+    return static_cast<GRepr*>(this)->AddEdges(edges, policy, threads);
+  }
+};
+
+template <bool kDirected, typename V = Vertex, typename W = Weight>
+class AdjacencyMatrix;
+template <bool kDirected, typename V = Vertex, typename W = Weight>
+class AdjacencyList;
+
+template <bool kDirected, typename V, typename W>
+struct GraphTraits<AdjacencyMatrix<kDirected, V, W>> : GraphTypes<V, W> {};
+template <bool kDirected, typename V, typename W>
+struct GraphTraits<AdjacencyList<kDirected, V, W>> : GraphTypes<V, W> {};
+
+// Whether a representation is an AdjacencyMatrix, whose rows algorithms may scan
+// directly.
+template <class GRepr>
+struct IsAdjacencyMatrix : std::false_type {};
+template <bool kDirected, typename V, typename W>
+struct IsAdjacencyMatrix<AdjacencyMatrix<kDirected, V, W>> : std::true_type {};
+
+namespace detail {
+
+// Square weight matrix kept as one row per vertex.
+template <typename W>
+class FullMatrix {
+ public:
+  explicit FullMatrix(std::pmr::memory_resource* resource) : rows_(resource) {}
+
+  W& operator()(const size_t i, const size_t j) { return rows_[i][j]; }
+  W operator()(const size_t i, const size_t j) const { return rows_[i][j]; }
+  const W* Row(const size_t i, W*) const { return rows_[i].data(); }
+  size_t size() const { return rows_.size(); }
+  static size_t Bytes(const size_t vertices) {
+    return vertices * (vertices * sizeof(W) + sizeof(std::pmr::vector<W>));
+  }
+  std::pmr::memory_resource* resource() const { return rows_.get_allocator().resource(); }
+
+  void Resize(const size_t vertices) {
+    if (vertices <= rows_.size()) return;
+    const size_t prev_size = rows_.size();
+    rows_.resize(vertices);
+    std::for_each(rows_.begin(), rows_.end(), [&](std::pmr::vector<W>& row) {
+      row.resize(vertices);
+      std::fill(row.begin() + prev_size, row.end(), 0);
+    });
+  }
+
+ private:
+  std::pmr::vector<std::pmr::vector<W>> rows_;
+};
+
+// Symmetric weight matrix storing only the lower triangle, row by row, so cell
+// (i, j) with i >= j lives at i * (i + 1) / 2 + j and growing the matrix only
+// appends rows.
+template <typename W>
+class PackedMatrix {
+ public:
+  explicit PackedMatrix(std::pmr::memory_resource* resource) : cells_(resource) {}
+
+  W& operator()(const size_t i, const size_t j) { return cells_[Index(i, j)]; }
+  W operator()(const size_t i, const size_t j) const { return cells_[Index(i, j)]; }
+  // Row i is contiguous up to the diagonal only, so it is gathered into `scratch`.
+  const W* Row(const size_t i, W* scratch) const {
+    std::copy_n(cells_.data() + i * (i + 1) / 2, i + 1, scratch);
+    for (size_t j = i + 1; j < size_; ++j) scratch[j] = cells_[j * (j + 1) / 2 + i];
+    return scratch;
+  }
+  size_t size() const { return size_; }
+  static size_t Bytes(const size_t vertices) { return vertices * (vertices + 1) / 2 * sizeof(W); }
+  std::pmr::memory_resource* resource() const { return cells_.get_allocator().resource(); }
+
+  void Resize(const size_t vertices) {
+    if (vertices <= size_) return;
+    cells_.resize(vertices * (vertices + 1) / 2, 0);
+    size_ = vertices;
+  }
+
+ private:
+  static size_t Index(const size_t i, const size_t j) { return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i; }
+
+  size_t size_ = 0;
+  std::pmr::vector<W> cells_;
 };
 
-class AdjacencyMatrix : public Graph<AdjacencyMatrix> {
+}  // namespace detail
+
+template <bool kDirected, typename V, typename W>
+class AdjacencyMatrix : public Graph<AdjacencyMatrix<kDirected, V, W>> {
  public:
-  AdjacencyMatrix(const bool is_directed) : is_directed_(is_directed) {}
-  AdjacencyMatrix(const bool is_directed, const size_t vertices) : is_directed_(is_directed) { Resize(vertices); }
+  static constexpr bool kIsDirected = kDirected;
+  using Vertex = V;
+  using Weight = W;
+  using Edge = typename GraphTypes<V, W>::Edge;
+  using WEdge = typename GraphTypes<V, W>::WEdge;
+  using EdgeArrays = typename GraphTypes<V, W>::EdgeArrays;
+  using Connection = typename GraphTypes<V, W>::Connection;
+  using Connections = typename GraphTypes<V, W>::Connections;
+  using Adjacent = typename GraphTypes<V, W>::Adjacent;
+
+  explicit AdjacencyMatrix(const size_t vertices = 0,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : g_(resource), vertices_(resource) {
+    g_.Resize(vertices);
+  }
+
+  // Memory of the weights of a matrix of `vertices`, to refuse one that would
+  // not fit before allocating it.
+  static size_t EstimateBytes(const size_t vertices) { return Cells::Bytes(vertices); }
 
   std::shared_ptr<const Adjacent> Adj() const {
-    auto adjacent = std::make_shared<Adjacent>(g_.size());
+    auto adjacent = std::make_shared<Adjacent>(g_.size(), Resource());
     for (size_t i = 0; i < g_.size(); ++i)
       for (size_t j = 0; j < g_.size(); ++j)
-        if (g_[i][j] != 0) (*adjacent)[i].emplace_back(j, g_[i][j]);
-    return std::move(adjacent);
+        if (g_(i, j) != 0) (*adjacent)[i].emplace_back(j, g_(i, j));
+    return adjacent;
+  }
+  template <typename Fn>
+  void ForEachNeighbour(const Vertex u, Fn fn) const {
+    for (size_t v = 0; v < g_.size(); ++v)
+      if (const W weight = g_(u, v); weight != 0) fn(static_cast<Vertex>(v), weight);
+  }
+  template <typename Fn>
+  void ForEachNeighbourWhile(const Vertex u, Fn fn) const {
+    for (size_t v = 0; v < g_.size(); ++v)
+      if (const W weight = g_(u, v); weight != 0 && !fn(static_cast<Vertex>(v), weight)) return;
   }
   std::unique_ptr<std::vector<WEdge>> Edges() const {
     auto edges = std::make_unique<std::vector<WEdge>>();
-    const auto col_start = [&](const size_t i) -> bool { return is_directed_ ? 0 : i; };
     for (size_t i = 0; i < g_.size(); ++i)
-      for (size_t j = col_start(i); j < g_.size(); ++j)
-        if (g_[i][j] != 0) edges->emplace_back(Edge(i, j), g_[i][j]);
+      for (size_t j = kDirected ? 0 : i; j < g_.size(); ++j)
+        if (g_(i, j) != 0) edges->emplace_back(Edge(i, j), g_(i, j));
     return edges;
   }
+  std::unique_ptr<EdgeArrays> EdgesByTarget() const {
+    const size_t n = g_.size();
+    auto arcs = std::make_unique<EdgeArrays>(Resource());
+    arcs->offsets.assign(n + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j)
+        if (g_(i, j) != 0) ++arcs->offsets[j + 1];
+    std::partial_sum(arcs->offsets.cbegin(), arcs->offsets.cend(), arcs->offsets.begin());
+    arcs->src.resize(arcs->offsets.back());
+    arcs->dst.resize(arcs->offsets.back());
+    arcs->w.resize(arcs->offsets.back());
+    std::vector<size_t> next(arcs->offsets.cbegin(), arcs->offsets.cend() - 1);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j)
+        if (g_(i, j) != 0) {
+          const size_t k = next[j]++;
+          arcs->src[k] = i;
+          arcs->dst[k] = j;
+          arcs->w[k] = g_(i, j);
+        }
+    return arcs;
+  }
   void Print() const {
-    std::printf("  |");
-    for (size_t i = 0; i < g_.size(); ++i) std::printf("  %2zu", i);
-    std::putchar('\n');
-    std::printf("--+");
-    for (size_t i = 0; i < g_.size(); ++i) std::printf("----");
-    std::putchar('\n');
+    output::Writer out;
+    out.Text("  |");
+    for (size_t i = 0; i < g_.size(); ++i) out.Text("  ").Number(i, 2);
+    out.Text("\n--+");
+    for (size_t i = 0; i < g_.size(); ++i) out.Text("----");
+    out.Char('\n');
     for (size_t i = 0; i < g_.size(); ++i) {
-      std::printf("%2zu|", i);
-      for (size_t j = 0; j < g_.size(); ++j) std::printf(" %3d", g_[i][j]);
-      std::putchar('\n');
+      out.Number(i, 2).Char('|');
+      for (size_t j = 0; j < g_.size(); ++j) out.Char(' ').Number(static_cast<int64_t>(g_(i, j)), 3);
+      out.Char('\n');
     }
-    std::fflush(stdout);
   }
-  std::unique_ptr<std::set<Vertex>> Vertices() const { return std::make_unique<std::set<Vertex>>(vertices_); }
+  std::unique_ptr<std::set<Vertex>> Vertices() const {
+    return std::make_unique<std::set<Vertex>>(vertices_.cbegin(), vertices_.cend());
+  }
   size_t VerticesNo() const { return vertices_.size(); }
+  std::pmr::memory_resource* Resource() const { return g_.resource(); }
+
+  // Number of rows and columns, at least VerticesNo().
+  size_t Dimension() const { return g_.size(); }
+  // Weights of the edges leaving `u` indexed by the target, 0 for no edge. The
+  // row may be gathered into `scratch` of Dimension() weights, it is valid
+  // until the graph or `scratch` changes.
+  const Weight* Row(const Vertex u, Weight* scratch) const { return g_.Row(u, scratch); }
+  // Whether a negative weight has ever been added.
+  bool HasNegativeWeights() const { return has_negative_weights_; }
 
   void AddEdge(const WEdge& edge) { AddEdge(edge.first.first, edge.first.second, edge.second); }
   void AddEdge(const Vertex vb, const Vertex ve, const Weight w) {
     vertices_.insert({vb, ve});
-    const Vertex max_v = std::max(vb, ve);
-    if (max_v >= g_.size()) Resize(max_v + 1);
-    g_[vb][ve] = w;
-    if (!is_directed_) g_[ve][vb] = w;
+    g_.Resize(static_cast<size_t>(std::max(vb, ve)) + 1);
+    g_(vb, ve) = w;
+    has_negative_weights_ |= w < 0;
   }
-
- private:
-  void Resize(const size_t vertices) {
-    if (vertices <= g_.size()) return;
-    const size_t prev_size = g_.size();
-    g_.resize(vertices);
-    std::for_each(g_.begin(), g_.end(), [&](std::vector<Weight>& row) {
-      row.resize(vertices);
-      std::fill(row.begin() + prev_size, row.end(), 0);
+  // The vertices stay, HasNegativeWeights() is not cleared by the removal or
+  // update of the last negative edge.
+  bool RemoveEdge(const Vertex vb, const Vertex ve) {
+    if (static_cast<size_t>(std::max(vb, ve)) >= g_.size() || g_(vb, ve) == 0) return false;
+    g_(vb, ve) = 0;
+    return true;
+  }
+  // A zero weight removes the edge, as in AddEdge.
+  bool UpdateWeight(const Vertex vb, const Vertex ve, const Weight w) {
+    if (static_cast<size_t>(std::max(vb, ve)) >= g_.size() || g_(vb, ve) == 0) return false;
+    g_(vb, ve) = w;
+    has_negative_weights_ |= w < 0;
+    return true;
+  }
+  // Add a batch of edges with the storage resized once and the rows filled in
+  // parallel by `threads` threads. Return false, leaving the graph unchanged, if
+  // the policy is Duplicates::kReject and an edge is repeated or already exists.
+  bool AddEdges(const std::vector<WEdge>& edges, const Duplicates policy = Duplicates::kKeep,
+                const size_t threads = 1) {
+    const size_t vertex_no = std::max(g_.size(), detail::VertexBound(edges));
+    const detail::Buckets<V, W> buckets = detail::Bucketize(edges, vertex_no, kDirected, threads);
+    if (policy == Duplicates::kReject) {
+      std::atomic<bool> rejected{false};
+      parallel::For(threads, vertex_no, [&](size_t, const size_t begin, const size_t end) {
+        std::vector<Connection> unique;
+        for (Vertex u = begin; u < end && !rejected; ++u) {
+          if (!detail::Deduplicate(buckets.begin(u), buckets.end(u), policy, unique)) rejected = true;
+          for (const auto& [v, weight] : unique)
+            if (u < g_.size() && v < g_.size() && g_(u, v) != 0) rejected = true;
+        }
+      });
+      if (rejected) return false;
+    }
+    g_.Resize(vertex_no);
+    std::vector<bool> present(vertex_no, false);
+    for (const auto& [edge, weight] : edges) {
+      present[edge.first] = present[edge.second] = true;
+      has_negative_weights_ |= weight < 0;
+    }
+    for (Vertex v = 0; v < vertex_no; ++v)
+      if (present[v]) vertices_.insert(vertices_.end(), v);
+    // Each row is written only by the thread owning its bucket; an undirected arc
+    // is stored in both buckets, so only the one owning the packed row writes it.
+    parallel::For(threads, vertex_no, [&](size_t, const size_t begin, const size_t end) {
+      for (Vertex u = begin; u < end; ++u)
+        for (const Connection* arc = buckets.begin(u); arc != buckets.end(u); ++arc) {
+          if (!kDirected && arc->first > u) continue;
+          Weight& cell = g_(u, arc->first);
+          cell = policy == Duplicates::kKeepMin && cell != 0 ? std::min(cell, arc->second) : arc->second;
+        }
     });
+    return true;
   }
 
-  const bool is_directed_;
+ private:
+  using Cells = std::conditional_t<kDirected, detail::FullMatrix<W>, detail::PackedMatrix<W>>;
 
-  std::vector<std::vector<Weight>> g_;
-  std::set<Vertex> vertices_;
+  Cells g_;
+  std::pmr::set<Vertex> vertices_;
+  bool has_negative_weights_{false};
 };
 
-class AdjacencyList : public Graph<AdjacencyList> {
+template <bool kDirected, typename V, typename W>
+class AdjacencyList : public Graph<AdjacencyList<kDirected, V, W>> {
  public:
-  AdjacencyList(const bool is_directed) : is_directed_(is_directed), g_(std::make_shared<Adjacent>()){};
-  AdjacencyList(const bool is_directed, const size_t vertices)
-      : is_directed_(is_directed), g_(std::make_shared<Adjacent>()) {
-    g_->resize(vertices);
+  static constexpr bool kIsDirected = kDirected;
+  using Vertex = V;
+  using Weight = W;
+  using Edge = typename GraphTypes<V, W>::Edge;
+  using WEdge = typename GraphTypes<V, W>::WEdge;
+  using EdgeArrays = typename GraphTypes<V, W>::EdgeArrays;
+  using Connection = typename GraphTypes<V, W>::Connection;
+  using Connections = typename GraphTypes<V, W>::Connections;
+  using Adjacent = typename GraphTypes<V, W>::Adjacent;
+
+  explicit AdjacencyList(const size_t vertices = 0,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : g_(std::make_shared<Adjacent>(vertices, resource)) {}
+  // A copy owns its adjacency, so either graph can change without affecting the
+  // other.
+  AdjacencyList(const AdjacencyList& other) : g_(std::make_shared<Adjacent>(*other.g_, other.Resource())) {}
+  AdjacencyList(AdjacencyList&&) = default;
+  AdjacencyList& operator=(const AdjacencyList& other) {
+    if (this != &other) g_ = std::make_shared<Adjacent>(*other.g_, other.Resource());
+    return *this;
   }
+  AdjacencyList& operator=(AdjacencyList&&) = default;
 
   std::shared_ptr<const Adjacent> Adj() const { return g_; }
+  template <typename Fn>
+  void ForEachNeighbour(const Vertex u, Fn fn) const {
+    for (const auto& [v, weight] : (*g_)[u]) fn(v, weight);
+  }
+  template <typename Fn>
+  void ForEachNeighbourWhile(const Vertex u, Fn fn) const {
+    for (const auto& [v, weight] : (*g_)[u])
+      if (!fn(v, weight)) return;
+  }
   std::unique_ptr<std::vector<WEdge>> Edges() const {
     auto edges = std::make_unique<std::vector<WEdge>>();
     for (auto it = g_->cbegin(); it != g_->cend(); ++it) {
@@ -137,20 +420,37 @@ class AdjacencyList : public Graph<AdjacencyList> {
     }
     return edges;
   }
+  std::unique_ptr<EdgeArrays> EdgesByTarget() const {
+    auto arcs = std::make_unique<EdgeArrays>(Resource());
+    arcs->offsets.assign(g_->size() + 1, 0);
+    for (const Connections& connections : *g_)
+      for (const Connection& connection : connections) ++arcs->offsets[connection.first + 1];
+    std::partial_sum(arcs->offsets.cbegin(), arcs->offsets.cend(), arcs->offsets.begin());
+    arcs->src.resize(arcs->offsets.back());
+    arcs->dst.resize(arcs->offsets.back());
+    arcs->w.resize(arcs->offsets.back());
+    std::vector<size_t> next(arcs->offsets.cbegin(), arcs->offsets.cend() - 1);
+    for (size_t u = 0; u < g_->size(); ++u)
+      for (const auto& [v, weight] : (*g_)[u]) {
+        const size_t k = next[v]++;
+        arcs->src[k] = u;
+        arcs->dst[k] = v;
+        arcs->w[k] = weight;
+      }
+    return arcs;
+  }
   void Print() const {
+    output::Writer out;
     for (size_t i = 0; i < g_->size(); ++i) {
       const Connections& connections = (*g_)[i];
       if (connections.size() == 0) continue;
-      std::printf("%zu:", i);
-      typename Connections::const_iterator it = connections.cbegin();
-      if (it != connections.cend())
-        while (true) {
-          std::printf(" (%zu, %" PRId32 ")", it->first, it->second);
-          if (++it == connections.cend()) break;
-          std::putchar(',');
-        }
-      std::putchar('\n');
-      std::fflush(stdout);
+      out.Number(i).Char(':');
+      const char* separator = " (";
+      for (const auto& [v, weight] : connections) {
+        out.Text(separator).Number(static_cast<size_t>(v)).Text(", ").Number(static_cast<int64_t>(weight)).Char(')');
+        separator = ", (";
+      }
+      out.Char('\n');
     }
   }
   std::unique_ptr<std::set<Vertex>> Vertices() const {
@@ -163,22 +463,118 @@ class AdjacencyList : public Graph<AdjacencyList> {
     return vertices;
   }
   size_t VerticesNo() const { return g_->size(); }
+  std::pmr::memory_resource* Resource() const { return g_->get_allocator().resource(); }
 
   void AddEdge(const WEdge& edge) { AddEdge(edge.first.first, edge.first.second, edge.second); }
-  void AddEdge(const Vertex vb, const Vertex ve, const int32_t w) {
-    const Vertex max_v = std::max(vb, ve);
+  void AddEdge(const Vertex vb, const Vertex ve, const Weight w) {
+    const size_t max_v = std::max(vb, ve);
     if (max_v >= g_->size()) g_->resize(max_v + 1);
     (*g_)[vb].emplace_back(ve, w);
-    if (!is_directed_) (*g_)[ve].emplace_back(vb, w);
+    if (!kDirected) (*g_)[ve].emplace_back(vb, w);
+  }
+  // Of parallel edges the first one is removed or updated.
+  bool RemoveEdge(const Vertex vb, const Vertex ve) {
+    const auto it = FindArc(vb, ve);
+    if (!it) return false;
+    const Weight w = (*it)->second;
+    (*g_)[vb].erase(*it);
+    if (!kDirected && vb != ve) (*g_)[ve].erase(*FindArc(ve, vb, &w));
+    return true;
+  }
+  bool UpdateWeight(const Vertex vb, const Vertex ve, const Weight w) {
+    const auto it = FindArc(vb, ve);
+    if (!it) return false;
+    const Weight prev = (*it)->second;
+    (*it)->second = w;
+    if (!kDirected && vb != ve) (*FindArc(ve, vb, &prev))->second = w;
+    return true;
+  }
+  // Add a batch of edges with the storage resized once and the edges placed per
+  // source vertex, by `threads` threads if the memory resource allows concurrent
+  // allocations. Return false, leaving the graph unchanged, if the policy is
+  // Duplicates::kReject and an edge is repeated or already exists.
+  bool AddEdges(const std::vector<WEdge>& edges, const Duplicates policy = Duplicates::kKeep, size_t threads = 1) {
+    if (!detail::IsThreadSafe(Resource())) threads = 1;
+    const size_t vertex_no = std::max(g_->size(), detail::VertexBound(edges));
+    const detail::Buckets<V, W> buckets = detail::Bucketize(edges, vertex_no, kDirected, threads);
+    // Targets of the existing connections of `u`, sorted.
+    const auto existing = [this](const Vertex u, std::vector<Vertex>& targets) {
+      targets.clear();
+      if (u >= g_->size()) return;
+      for (const Connection& connection : (*g_)[u]) targets.push_back(connection.first);
+      std::sort(targets.begin(), targets.end());
+    };
+    if (policy == Duplicates::kReject) {
+      std::atomic<bool> rejected{false};
+      parallel::For(threads, vertex_no, [&](size_t, const size_t begin, const size_t end) {
+        std::vector<Connection> unique;
+        std::vector<Vertex> targets;
+        for (Vertex u = begin; u < end && !rejected; ++u) {
+          if (!detail::Deduplicate(buckets.begin(u), buckets.end(u), policy, unique)) rejected = true;
+          if (unique.empty()) continue;
+          existing(u, targets);
+          for (const auto& [v, weight] : unique)
+            if (std::binary_search(targets.cbegin(), targets.cend(), v)) rejected = true;
+        }
+      });
+      if (rejected) return false;
+    }
+    g_->resize(vertex_no);
+    const bool merge = policy == Duplicates::kKeepMin || policy == Duplicates::kKeepLast;
+    // Each list is written only by the thread owning its bucket.
+    parallel::For(threads, vertex_no, [&](size_t, const size_t begin, const size_t end) {
+      std::vector<Connection> unique;
+      std::vector<bool> merged;
+      for (Vertex u = begin; u < end; ++u) {
+        detail::Deduplicate(buckets.begin(u), buckets.end(u), policy, unique);
+        Connections& connections = (*g_)[u];
+        merged.assign(unique.size(), false);
+        if (merge)
+          for (Connection& connection : connections) {
+            auto it = std::lower_bound(unique.cbegin(), unique.cend(), connection.first,
+                                       [](const Connection& arc, const Vertex v) -> bool { return arc.first < v; });
+            if (it == unique.cend() || it->first != connection.first) continue;
+            connection.second =
+                policy == Duplicates::kKeepMin ? std::min(connection.second, it->second) : it->second;
+            merged[it - unique.cbegin()] = true;
+          }
+        for (size_t i = 0; i < unique.size(); ++i)
+          if (!merged[i]) connections.push_back(unique[i]);
+      }
+    });
+    return true;
   }
 
  private:
-  const bool is_directed_;
+  // The first arc (vb, ve), of weight *w if given.
+  std::optional<typename Connections::iterator> FindArc(const Vertex vb, const Vertex ve,
+                                                        const Weight* w = nullptr) const {
+    if (static_cast<size_t>(std::max(vb, ve)) >= g_->size()) return std::nullopt;
+    Connections& connections = (*g_)[vb];
+    const auto it = std::find_if(connections.begin(), connections.end(), [ve, w](const Connection& connection) {
+      return connection.first == ve && (w == nullptr || connection.second == *w);
+    });
+    if (it == connections.end()) return std::nullopt;
+    return it;
+  }
 
   // v -> [(u, weight), ...]
   std::shared_ptr<Adjacent> g_;
 };
 
+#define SDIZO_EXTERN_GRAPHS(V, W)                     \
+  extern template class AdjacencyMatrix<true, V, W>;  \
+  extern template class AdjacencyMatrix<false, V, W>; \
+  extern template class AdjacencyList<true, V, W>;    \
+  extern template class AdjacencyList<false, V, W>;
+SDIZO_FOR_EACH_GRAPH_TYPES(SDIZO_EXTERN_GRAPHS)
+#undef SDIZO_EXTERN_GRAPHS
+
+using DirectedMatrix = AdjacencyMatrix<true>;
+using UndirectedMatrix = AdjacencyMatrix<false>;
+using DirectedList = AdjacencyList<true>;
+using UndirectedList = AdjacencyList<false>;
+
 }  // namespace sdizo
 
 #endif  // SDIZO_GRAPH_HPP_
@@ -48,6 +48,41 @@ fill_weights:
   return edges;
 }
 
+std::vector<WEdge> GraphGenerator::GenerateSparse(const size_t vertex_no, const size_t degree, const bool is_directed,
+                                                  Vertex* vb) {
+  const size_t edges_limit = (vertex_no * vertex_no - vertex_no) / (is_directed ? 1 : 2);
+  const size_t edges_no = std::min(edges_limit, std::max(vertex_no - 1, vertex_no * degree / 2));
+  std::set<WEdge> spanning_tree;
+  SpanningTree(spanning_tree, vertex_no, is_directed);
+  std::vector<WEdge> edges;
+  edges.reserve(edges_no);
+  for (auto it = spanning_tree.begin(); it != spanning_tree.end();)
+    edges.push_back(std::move(spanning_tree.extract(it++).value()));
+  const WEdge first = edges.front();
+  std::uniform_int_distribution<Vertex> vdistr(0, vertex_no - 1);
+  const auto edge_less = [](const WEdge& lhs, const WEdge& rhs) -> bool { return lhs.first < rhs.first; };
+  const auto edge_equal = [](const WEdge& lhs, const WEdge& rhs) -> bool { return lhs.first == rhs.first; };
+  // Duplicates are rare in sparse graphs, so draw the missing edges and drop
+  // the repeated ones until the requested number is reached.
+  while (edges.size() < edges_no) {
+    for (size_t i = edges.size(); i < edges_no; ++i) {
+      Vertex u, v;
+      do {
+        u = vdistr(gen_);
+        v = vdistr(gen_);
+      } while (u == v);
+      if (!is_directed && u > v) std::swap(u, v);
+      edges.emplace_back(Edge(u, v), 0);
+    }
+    std::sort(edges.begin(), edges.end(), edge_less);
+    edges.erase(std::unique(edges.begin(), edges.end(), edge_equal), edges.end());
+  }
+  std::shuffle(edges.begin(), edges.end(), gen_);
+  std::for_each(edges.begin(), edges.end(), [this](WEdge& edge) { edge.second = distr_(gen_); });
+  if (vb != nullptr) *vb = first.first.first;
+  return edges;
+}
+
 void GraphGenerator::SpanningTree(std::set<WEdge>& spanning_tree, const size_t vertex_no, const bool is_directed) {
   const auto reorder = is_directed ? [](Vertex&, Vertex&) {} : [](Vertex& u, Vertex& v) {
     if (u > v) std::swap(u, v);
@@ -34,6 +34,10 @@ class GraphGenerator {
 
   /// @param density - A number from the (0, 100] interval.
   std::vector<WEdge> Generate(size_t vertex_no, size_t density, bool is_directed, Vertex* vb = nullptr);
+  /// Generate a connected graph with `degree` edges per vertex on average,
+  /// without enumerating all vertex pairs, so it scales to millions of vertices.
+  /// @param degree - Average number of edges incident to a vertex.
+  std::vector<WEdge> GenerateSparse(size_t vertex_no, size_t degree, bool is_directed, Vertex* vb = nullptr);
 
  private:
   void SpanningTree(std::set<WEdge>& edges, size_t vertex_no, bool is_directed);
@@ -19,8 +19,27 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <cerrno>
+
+#include "idmap.hpp"
+
 namespace sdizo {
 
+namespace {
+
+// Read a vertex label, any unsigned 64-bit integer. Negative and out of range
+// labels are rejected instead of being wrapped or clamped by fscanf.
+bool ReadLabel(FILE* fp, uint64_t& label) {
+  if (std::fscanf(fp, " ") == EOF) return false;
+  const int c = std::fgetc(fp);
+  if (c == EOF || c == '-' || std::ungetc(c, fp) == EOF) return false;
+  errno = 0;
+  return std::fscanf(fp, "%" SCNu64, &label) == 1 && errno != ERANGE;
+}
+
+}  // namespace
+
 GraphReader::~GraphReader() {
   if (fp_ != nullptr) std::fclose(fp_);
 }
@@ -34,16 +53,22 @@ bool GraphReader::Open(const char* path, size_t& v, size_t& e, size_t* vb, size_
     return false;
   }
 
-  int64_t e_read, v_read, vb_read, ve_read;
-  if (std::fscanf(fp_, "%" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 " \n", &e_read, &v_read, &vb_read, &ve_read) !=
-          4 ||
-      v_read < 1) {
+  int64_t e_read, v_read;
+  uint64_t vb_read, ve_read;
+  if (std::fscanf(fp_, "%" PRId64 " %" PRId64, &e_read, &v_read) != 2 || v_read < 1 || !ReadLabel(fp_, vb_read) ||
+      !ReadLabel(fp_, ve_read)) {
     std::fclose(fp_);
     fp_ = nullptr;
     return false;
   }
   v = v_read;
   e = e_read;
+  if (ids_ != nullptr) {
+    // The vertex count only hints the map size, it is not a bound of the labels.
+    ids_->Reserve(std::min<size_t>(v, e_read * 2));
+    vb_read = ids_->Map(vb_read);
+    ve_read = ids_->Map(ve_read);
+  }
   if (vb != nullptr) *vb = vb_read;
   if (ve != nullptr) *ve = ve_read;
   offset_ = 0;
@@ -54,11 +79,14 @@ bool GraphReader::Open(const char* path, size_t& v, size_t& e, size_t* vb, size_
 bool GraphReader::ReadEdge(size_t& vb, size_t& ve, int32_t* weight) {
   if (offset_ >= Size()) return false;
   ++offset_;
-  int64_t vb_read, ve_read;
+  uint64_t vb_read, ve_read;
   int32_t weight_read;
-  if (std::fscanf(fp_, "%" PRId64 " %" PRId64 " %" PRId32 " \n", &vb_read, &ve_read, &weight_read) != 3) return false;
-  vb = vb_read;
-  ve = ve_read;
+  if (!ReadLabel(fp_, vb_read) || !ReadLabel(fp_, ve_read) || std::fscanf(fp_, "%" PRId32 " \n", &weight_read) != 1) {
+    std::fprintf(stderr, "Error: Invalid edge %zu\n", offset_);
+    return false;
+  }
+  vb = ids_ != nullptr ? ids_->Map(vb_read) : vb_read;
+  ve = ids_ != nullptr ? ids_->Map(ve_read) : ve_read;
   if (weight != nullptr) *weight = weight_read;
   return true;
 }
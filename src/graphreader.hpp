@@ -26,6 +26,8 @@
 
 namespace sdizo {
 
+class IdMap;
+
 class GraphReader {
  public:
   GraphReader() = default;
@@ -33,11 +35,16 @@ class GraphReader {
 
   size_t Size() const;
 
+  // Read the vertices as labels compacted by `ids` to dense ids, from the next
+  // Open() on. The number of vertices is ids->Size() after the last edge.
+  void CompactIds(IdMap* ids) { ids_ = ids; }
+
   bool Open(const char* path, size_t& v, size_t& e, size_t* vb, size_t* ve);
   bool ReadEdge(size_t& vb, size_t& ve, int32_t* w);
 
  private:
   FILE* fp_{nullptr};
+  IdMap* ids_{nullptr};
   size_t offset_{0};
   size_t size_{0};
 };
@@ -20,15 +20,68 @@
 #include <cinttypes>
 #include <cstddef>
 #include <list>
+#include <memory_resource>
+#include <set>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace sdizo {
 
+// Arcs of a graph as separate arrays grouped by the target vertex: the arcs
+// offsets[v]..offsets[v + 1] enter v, ordered by the source. Undirected edges
+// appear in both directions.
+template <typename V, typename W>
+struct EdgeArrays {
+  explicit EdgeArrays(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : offsets(resource), src(resource), dst(resource), w(resource) {}
+
+  size_t size() const { return src.size(); }
+
+  std::pmr::vector<size_t> offsets;
+  std::pmr::vector<V> src;
+  std::pmr::vector<V> dst;
+  std::pmr::vector<W> w;
+};
+
+// Types of a graph with vertex ids of type V and edge weights of type W. Path
+// lengths are summed as Distance, which is at least 32 bits wide, so 16-bit
+// weights do not overflow on long paths; use 64-bit weights for 64-bit sums.
+template <typename V, typename W>
+struct GraphTypes {
+  static_assert(std::is_unsigned_v<V> && std::is_signed_v<W>);
+
+  using Vertex = V;
+  using Weight = W;
+  using Distance = std::conditional_t<(sizeof(W) < sizeof(int32_t)), int32_t, W>;
+  using Edge = std::pair<V, V>;
+  using WEdge = std::pair<Edge, W>;
+  using EdgeArrays = sdizo::EdgeArrays<V, W>;
+  using Connection = std::pair<V, W>;
+  using Connections = std::pmr::list<Connection>;
+  using Adjacent = std::pmr::vector<Connections>;
+  using SpanningTree = std::pmr::set<WEdge>;
+  // (predecessors, distances)
+  using PathCost = std::pair<std::pmr::vector<V>, std::pmr::vector<Distance>>;
+};
+
+// Vertex and weight type combinations compiled into the library, X(V, W) is
+// expanded once for each. The first one is the default.
+#define SDIZO_FOR_EACH_GRAPH_TYPES(X) \
+  X(size_t, int32_t)                  \
+  X(uint32_t, int16_t)                \
+  X(uint32_t, int32_t)                \
+  X(uint32_t, int64_t)
+
 using Vertex = size_t;
 using Weight = int32_t;
-using Edge = std::pair<Vertex, Vertex>;
-using WEdge = std::pair<Edge, Weight>;
+using Edge = GraphTypes<Vertex, Weight>::Edge;
+using WEdge = GraphTypes<Vertex, Weight>::WEdge;
+using Connection = GraphTypes<Vertex, Weight>::Connection;
+using Connections = GraphTypes<Vertex, Weight>::Connections;
+using Adjacent = GraphTypes<Vertex, Weight>::Adjacent;
+using SpanningTree = GraphTypes<Vertex, Weight>::SpanningTree;
+using PathCost = GraphTypes<Vertex, Weight>::PathCost;
 
 }  // namespace sdizo
 
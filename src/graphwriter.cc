@@ -0,0 +1,58 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "graphwriter.hpp"
+
+#include <errno.h>
+
+namespace sdizo {
+
+GraphWriter::~GraphWriter() {
+  if (fp_ != nullptr) std::fclose(fp_);
+}
+
+bool GraphWriter::Open(const char* path) {
+  if (fp_ != nullptr) Close();
+  fp_ = std::fopen(path, "w");
+  if (fp_ == nullptr) {
+    std::fprintf(stderr, "Error: Open file path=[%s], errno=%d\n", path, errno);
+    return false;
+  }
+  failed_ = false;
+  return true;
+}
+
+bool GraphWriter::Close() {
+  if (fp_ == nullptr) return false;
+  const bool closed = std::fclose(fp_) == 0;
+  fp_ = nullptr;
+  return closed && !failed_;
+}
+
+bool GraphWriter::Write(const std::vector<WEdge>& edges, const size_t v, const size_t vb, const size_t ve) {
+  if (!WriteHeader(edges.size(), v, vb, ve)) return false;
+  return WriteChunks(edges.size(), kEdgeChunk, [&edges](std::string& out, const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; ++i) AppendEdge(out, edges[i].first.first, edges[i].first.second, edges[i].second);
+  });
+}
+
+bool GraphWriter::WriteHeader(const size_t e, const size_t v, const size_t vb, const size_t ve) {
+  if (fp_ == nullptr) return false;
+  if (std::fprintf(fp_, "%zu %zu %zu %zu\n", e, v, vb, ve) < 0) failed_ = true;
+  return !failed_;
+}
+
+}  // namespace sdizo
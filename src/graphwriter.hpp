@@ -0,0 +1,113 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_GRAPHWRITER_HPP_
+#define SDIZO_GRAPHWRITER_HPP_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "graph.hpp"
+#include "graphtype.hpp"
+#include "output.hpp"
+#include "parallel.hpp"
+
+namespace sdizo {
+
+// Writer of the text format GraphReader reads: the header "e v vb ve" and one
+// "u v weight" line per edge. The lines are formatted in chunks, on several
+// threads if asked to, and written in order.
+class GraphWriter {
+  static constexpr size_t kEdgeChunk = 1 << 16;
+  static constexpr size_t kVertexChunk = 1 << 12;
+  // Chunks formatted by each thread between the writes.
+  static constexpr size_t kChunksPerThread = 4;
+
+ public:
+  GraphWriter() = default;
+  ~GraphWriter();
+
+  // Format the edges on up to `threads` threads, from the next Write() on.
+  void Threads(const size_t threads) { threads_ = std::max<size_t>(1, threads); }
+
+  bool Open(const char* path);
+  // Close the file, false if any write to it failed.
+  bool Close();
+
+  // Write the `edges` of a graph of `v` vertices, starting at `vb` and ending at
+  // `ve`.
+  bool Write(const std::vector<WEdge>& edges, size_t v, size_t vb = 0, size_t ve = 0);
+  // Write the edges of `g`, each undirected edge once.
+  template <typename GRepr>
+  bool Write(const Graph<GRepr>& g, const size_t vb = 0, const size_t ve = 0) {
+    using Vertex = typename Graph<GRepr>::Vertex;
+    using Weight = typename Graph<GRepr>::Weight;
+    const size_t v = g.VerticesNo();
+    size_t e = 0;
+    for (size_t u = 0; u < v; ++u)
+      g.ForEachNeighbour(u, [&e, u](const Vertex w, Weight) { e += GRepr::kIsDirected || w >= u; });
+    if (!WriteHeader(e, v, vb, ve)) return false;
+    return WriteChunks(v, kVertexChunk, [&g](std::string& out, const size_t begin, const size_t end) {
+      for (size_t u = begin; u < end; ++u)
+        g.ForEachNeighbour(u, [&out, u](const Vertex w, const Weight weight) {
+          if (GRepr::kIsDirected || w >= u) AppendEdge(out, u, w, weight);
+        });
+    });
+  }
+
+ private:
+  static void AppendEdge(std::string& out, const size_t u, const size_t v, const int64_t weight) {
+    output::Append(out, u);
+    out += ' ';
+    output::Append(out, v);
+    out += ' ';
+    output::Append(out, weight);
+    out += '\n';
+  }
+
+  bool WriteHeader(size_t e, size_t v, size_t vb, size_t ve);
+  // Split [0, n) into chunks of `chunk`, let format(out, begin, end) append the
+  // lines of each and write them in order.
+  template <typename FormatFn>
+  bool WriteChunks(const size_t n, const size_t chunk, FormatFn format) {
+    const size_t chunks = (n + chunk - 1) / chunk;
+    std::vector<std::string> buffers(threads_ * kChunksPerThread);
+    for (size_t first = 0; first < chunks && !failed_; first += buffers.size()) {
+      const size_t count = std::min(buffers.size(), chunks - first);
+      parallel::For(threads_, count, [&](size_t, const size_t begin, const size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+          buffers[c].clear();
+          format(buffers[c], (first + c) * chunk, std::min(n, (first + c + 1) * chunk));
+        }
+      });
+      for (size_t c = 0; c < count; ++c)
+        if (std::fwrite(buffers[c].data(), 1, buffers[c].size(), fp_) != buffers[c].size()) failed_ = true;
+    }
+    return !failed_;
+  }
+
+  FILE* fp_{nullptr};
+  size_t threads_{1};
+  bool failed_{false};
+};
+
+}  // namespace sdizo
+
+#endif  // SDIZO_GRAPHWRITER_HPP_
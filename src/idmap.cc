@@ -0,0 +1,39 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "idmap.hpp"
+
+namespace sdizo {
+
+size_t IdMap::Map(const uint64_t label) {
+  const auto [it, inserted] = ids_.try_emplace(label, labels_.size());
+  if (inserted) labels_.push_back(label);
+  return it->second;
+}
+
+bool IdMap::Find(const uint64_t label, size_t& v) const {
+  const auto it = ids_.find(label);
+  if (it == ids_.cend()) return false;
+  v = it->second;
+  return true;
+}
+
+void IdMap::Reserve(const size_t n) {
+  ids_.reserve(n);
+  labels_.reserve(n);
+}
+
+}  // namespace sdizo
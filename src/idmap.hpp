@@ -0,0 +1,51 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_IDMAP_HPP_
+#define SDIZO_IDMAP_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace sdizo {
+
+// Dense relabelling of arbitrary 64-bit vertex labels to the ids 0..V-1, in the
+// order of their first appearance, so that sparse external keys do not size the
+// graph storage. The labels are translated back on output.
+class IdMap {
+ public:
+  IdMap() = default;
+
+  // Return the id of `label`, assigning the next free one if it is new.
+  size_t Map(uint64_t label);
+  // Set `v` to the id of `label`, return false if it has none.
+  bool Find(uint64_t label, size_t& v) const;
+  uint64_t Label(const size_t v) const { return labels_[v]; }
+  size_t Size() const { return labels_.size(); }
+
+  void Reserve(size_t n);
+
+ private:
+  std::unordered_map<uint64_t, size_t> ids_;
+  std::vector<uint64_t> labels_;
+};
+
+}  // namespace sdizo
+
+#endif  // SDIZO_IDMAP_HPP_
@@ -0,0 +1,31 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "instrument.hpp"
+
+#include <cstdio>
+
+namespace sdizo::detail {
+
+void Print(const instrument::Counters& counters) {
+  std::printf("Counters: edge_scans=%" PRIu64 " relaxations=%" PRIu64 " heap_pushes=%" PRIu64 " heap_pops=%" PRIu64
+              " decrease_keys=%" PRIu64 " stale_skips=%" PRIu64 " rounds=%" PRIu64 " finds=%" PRIu64
+              " unions=%" PRIu64 "\n",
+              counters.edge_scans, counters.relaxations, counters.heap_pushes, counters.heap_pops,
+              counters.decrease_keys, counters.stale_skips, counters.rounds, counters.finds, counters.unions);
+}
+
+}  // namespace sdizo::detail
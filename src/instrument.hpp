@@ -0,0 +1,100 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_INSTRUMENT_HPP_
+#define SDIZO_INSTRUMENT_HPP_
+
+#include <cinttypes>
+
+namespace sdizo {
+namespace instrument {
+
+// Internal work done by algorithm runs.
+struct Counters {
+  uint64_t edge_scans{0};   // Edges examined.
+  uint64_t relaxations{0};  // Edges which improved a tentative distance or key.
+  uint64_t heap_pushes{0};
+  uint64_t heap_pops{0};
+  uint64_t decrease_keys{0};  // Lowered keys of entries already in an indexed heap.
+  uint64_t stale_skips{0};  // Popped heap entries which were already outdated.
+  uint64_t rounds{0};       // Bellman-Ford passes over the edge list.
+  uint64_t finds{0};        // Disjoint-set lookups.
+  uint64_t unions{0};       // Disjoint-set merges.
+
+  Counters& operator+=(const Counters& other) {
+    edge_scans += other.edge_scans;
+    relaxations += other.relaxations;
+    heap_pushes += other.heap_pushes;
+    heap_pops += other.heap_pops;
+    decrease_keys += other.decrease_keys;
+    stale_skips += other.stale_skips;
+    rounds += other.rounds;
+    finds += other.finds;
+    unions += other.unions;
+    return *this;
+  }
+};
+
+// Instrumentation policy which ignores every event, all calls compile away.
+// Besides the events a policy answers Stop(), polled by the algorithms at every
+// heap pop, Bellman-Ford round and Kruskal edge. A run told to stop returns
+// early with a partial result.
+struct Disabled {
+  static constexpr bool kEnabled = false;
+
+  static constexpr bool Stop() { return false; }
+
+  void EdgeScan() {}
+  void EdgeScan(uint64_t) {}
+  void Relaxation() {}
+  void HeapPush() {}
+  void HeapPop() {}
+  void DecreaseKey() {}
+  void StaleSkip() {}
+  void Round() {}
+  void Find() {}
+  void Union() {}
+};
+
+// Instrumentation policy which accumulates every event.
+struct Enabled : Counters {
+  static constexpr bool kEnabled = true;
+
+  static constexpr bool Stop() { return false; }
+
+  void EdgeScan() { ++edge_scans; }
+  void EdgeScan(const uint64_t n) { edge_scans += n; }
+  void Relaxation() { ++relaxations; }
+  void HeapPush() { ++heap_pushes; }
+  void HeapPop() { ++heap_pops; }
+  void DecreaseKey() { ++decrease_keys; }
+  void StaleSkip() { ++stale_skips; }
+  void Round() { ++rounds; }
+  void Find() { ++finds; }
+  void Union() { ++unions; }
+};
+
+}  // namespace instrument
+
+namespace detail {
+
+void Print(const instrument::Counters& counters);
+
+}  // namespace detail
+
+}  // namespace sdizo
+
+#endif  // SDIZO_INSTRUMENT_HPP_
@@ -27,16 +27,41 @@ namespace {
 [[noreturn]] void ExitHelp(const char* prog, const bool exit_success = true) {
   std::fprintf(stderr,
                "\
-Usage: %s {--example {--input <path>} | --perf [--random] | --func {--input <path>}}\n\
+Usage: %s {--example {--input <path>} [--compact-ids] |\n\
+          --perf [--random] [--counters] [--repetitions <n>] [--save <path>] [--baseline <path> [--threshold <%%>]] |\n\
+          --bench [--random] |\n\
+          --perf-scale [--random] [--max-vertices <n>] [--budget <ms>] [--threads <n>] [--mem-cap <MB>] |\n\
+          --func {--input <path>} [--compact-ids] |\n\
+          --batch <trace> [--input <path>] [--compact-ids] [--random] [--threads <n>] |\n\
+          --serve <socket> {--input <path>} [--compact-ids] [--threads <n>] |\n\
+          --generate <vertices> <density> {--output <path>} [--undirected] [--random] [--threads <n>]}\n\
 \n\
 Required arguments:\n\
 \t--example\tRun example on all implemented algorithms and graph representations.\n\
 \t--perf\t\tPerformance mode.\n\
+\t--bench\t\tComponent benchmark mode, throughput of loading, building, updates and concurrent reads.\n\
+\t--perf-scale\tScaling mode, sparse graphs of geometrically increasing sizes.\n\
 \t--random\tRandom seed.\n\
 \t--func\t\tFunctional mode, test application functionalites.\n\
+\t--batch PATH\tReplay a trace of functional mode commands, print compact results and the throughput.\n\
+\t--serve PATH\tServer mode, answer queries on the graph of the input over a Unix socket.\n\
+\t--generate V D\tGenerate a graph of V vertices and D%% density (fractional), write it in the input format.\n\
 \n\
 Optional arguments:\n\
-\t--input PATH\tFile with data uses to initialize a graph.\n",
+\t--input PATH\tFile with data uses to initialize a graph.\n\
+\t--output PATH\tFile the generated graph is written to.\n\
+\t--undirected\tGenerate every edge once, for the undirected algorithms.\n\
+\t--compact-ids\tRead the vertices of the input as arbitrary 64-bit labels mapped to dense ids, print the labels.\n\
+\t--counters\tReport internal operation counters of algorithms in performance mode.\n\
+\t--repetitions N\tRepetitions of each cell in performance mode (default 100).\n\
+\t--save PATH\tSave the performance samples, tagged with the build and host, to a results file.\n\
+\t--baseline PATH\tCompare the performance samples against a saved results file, fail on a regression.\n\
+\t--threshold PCT\tMedian slowdown of a significantly slower cell which is a regression (default 5).\n\
+\t--max-vertices N\tThe largest graph in scaling mode (default 1048576).\n\
+\t--budget MS\tTime budget of a single algorithm at each size in scaling mode (default 1000).\n\
+\t--threads N\tThread count parallel algorithms are swept to, server workers, formatting threads of the\n\
+\t\t\tgenerated graph (default all cores), parallel queries in batch mode (default 1).\n\
+\t--mem-cap MB\tMemory a representation may use in scaling mode (default half of physical memory).\n",
                prog);
   std::exit(exit_success ? 0 : 1);
 }
@@ -52,10 +77,20 @@ int main(int argc, char* argv[]) {
   bool result = true;
   if (args.IsFlag("example"))
     result = test::Example(args);
+  else if (args.IsFlag("perf-scale"))
+    result = test::Scaling(args);
   else if (args.IsFlag("perf"))
     result = test::Performance(args);
+  else if (args.IsFlag("bench"))
+    result = test::Benchmark(args);
   else if (args.IsFlag("func"))
     result = test::Functional(args);
+  else if (args.IsOption("batch"))
+    result = test::Batch(args);
+  else if (args.IsOption("serve"))
+    result = test::Serve(args);
+  else if (args.IsOption("generate"))
+    result = test::Generate(args);
   else
     ExitHelp(argv[0], false);
   return result ? 0 : 1;
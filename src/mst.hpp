@@ -21,35 +21,78 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <set>
+#include <tuple>
 #include <vector>
 
+#include "components.hpp"
+#include "dheap.hpp"
 #include "graph.hpp"
+#include "instrument.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
 
 namespace sdizo::mst {
 
-constexpr auto kWeightInf = std::numeric_limits<Weight>::max();
+// Weight of the vertices not connected to the tree yet.
+template <typename W>
+constexpr W kWeightInf = std::numeric_limits<W>::max();
 
+namespace detail {
+
+// Fill `spanning_tree` with the edges (predecessors[v], v) of weight weights[v]
+// of the `tree` view, for every vertex v but the roots, their own predecessors,
+// and the vertices not reached, of weight kWeightInf.
 template <typename GRepr>
-std::unique_ptr<SpanningTree> Kruskal(std::shared_ptr<const Graph<GRepr>> g) {
+void FillSpanningTree(const typename Graph<GRepr>::PathCost& tree, typename Graph<GRepr>::SpanningTree& spanning_tree) {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Distance = typename Graph<GRepr>::Distance;
+  const auto& [predecessors, weights] = tree;
+  spanning_tree.clear();
+  for (Vertex v = 0; v < predecessors.size(); ++v)
+    if (predecessors[v] != v && weights[v] != kWeightInf<Distance>)
+      spanning_tree.emplace(typename Graph<GRepr>::Edge(predecessors[v], v),
+                            static_cast<typename Graph<GRepr>::Weight>(weights[v]));
+}
+
+}  // namespace detail
+
+// Kruskal's algorithm, a minimum spanning forest of a disconnected graph.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> Kruskal(
+    std::shared_ptr<const Graph<GRepr>> g, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using WEdge = typename Graph<GRepr>::WEdge;
+  using SpanningTree = typename Graph<GRepr>::SpanningTree;
+  using DisjointSet = std::pmr::set<Vertex>;
+  const std::pmr::polymorphic_allocator<DisjointSet> allocator(resource);
   auto edges = g->Edges();
   std::sort(edges->begin(), edges->end(),
             [](const auto& lhs, const auto& rhs) -> bool { return lhs.second < rhs.second; });
-  auto spanning_tree = std::make_unique<SpanningTree>();
-  std::map<Vertex, std::shared_ptr<std::set<Vertex>>> disjoint_sets;
+  auto spanning_tree = std::make_unique<SpanningTree>(resource);
+  std::pmr::map<Vertex, std::shared_ptr<DisjointSet>> disjoint_sets(resource);
   {
     auto vertices = g->Vertices();
     std::transform(vertices->cbegin(), vertices->cend(), std::inserter(disjoint_sets, disjoint_sets.end()),
-                   [](const Vertex v) -> std::pair<Vertex, std::shared_ptr<std::set<Vertex>>> {
-                     return std::make_pair(v, std::make_shared<std::set<Vertex>>(std::set<Vertex>({v})));
+                   [&allocator](const Vertex v) -> std::pair<Vertex, std::shared_ptr<DisjointSet>> {
+                     auto disjoint_set = std::allocate_shared<DisjointSet>(allocator);
+                     disjoint_set->insert(v);
+                     return std::make_pair(v, std::move(disjoint_set));
                    });
   }
   for (const WEdge& wedge : *edges) {
+    if (instr.Stop()) break;
+    instr.EdgeScan();
     auto& u_set = disjoint_sets[wedge.first.first];
+    instr.Find();
     auto& v_set = disjoint_sets[wedge.first.second];
+    instr.Find();
     if (u_set == v_set) continue;
+    instr.Union();
     spanning_tree->insert(wedge);
-    auto union_set = std::make_shared<std::set<Vertex>>();
+    auto union_set = std::allocate_shared<DisjointSet>(allocator);
     std::set_union(u_set->cbegin(), u_set->cend(), v_set->cbegin(), v_set->cend(),
                    std::inserter(*union_set, union_set->end()));
     for (const Vertex& w : *union_set) disjoint_sets[w] = union_set;
@@ -58,47 +101,253 @@ std::unique_ptr<SpanningTree> Kruskal(std::shared_ptr<const Graph<GRepr>> g) {
 }
 
 template <typename GRepr>
-std::unique_ptr<SpanningTree> Prim(std::shared_ptr<const Graph<GRepr>> g) {
-  struct Distance {
-    Distance(const Vertex v, const Weight weight) : v_(v), weight_(weight){};
-
-    Vertex v_;
-    Weight weight_;
-  };
-  struct distance_sort {
-    bool operator()(Distance const& lhs, Distance const& rhs) const { return lhs.weight_ > rhs.weight_; }
-  };
-  const size_t vertex_no = g->VerticesNo();
-  std::vector<Vertex> predecessors(vertex_no);
-  std::vector<Weight> weights(vertex_no, kWeightInf);
-  const Vertex vb{0};
-  std::vector<bool> visited(vertex_no, false);
-  visited[vb] = true;
-  std::vector<Distance> Q{{vb, 0}};
-  auto adjacents = g->Adj();
-  while (!Q.empty()) {
-    std::pop_heap(Q.begin(), Q.end(), distance_sort{});
-    const Distance distance = Q.back();
-    Q.pop_back();
-    const Vertex& u = distance.v_;
-    visited[u] = true;
-    if (distance.weight_ > weights[u]) continue;
-    weights[u] = distance.weight_;
-    for (const auto& [v, weight] : (*adjacents)[u]) {
-      if (!visited[v] && weight < weights[v]) {
-        Q.push_back({v, weight});
-        std::push_heap(Q.begin(), Q.end(), distance_sort{});
-        weights[v] = weight;
-        predecessors[v] = u;
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> Kruskal(std::shared_ptr<const Graph<GRepr>> g) {
+  instrument::Disabled instr;
+  return Kruskal<GRepr>(g, instr);
+}
+
+// Prim's algorithm which owns its scratch buffers, so repeated runs on the same
+// graph do not allocate. Between runs only the vertices touched by the previous
+// run are reset. The graph must not change during the lifetime of the engine.
+// `Queue` is the priority queue policy, LazyQueue or IndexedQueue. A tree is
+// grown from every vertex not reached by the previous ones, so a disconnected
+// graph gets its minimum spanning forest.
+template <typename GRepr, template <typename, typename> class Queue = LazyQueue>
+class PrimEngine {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Edge = typename Graph<GRepr>::Edge;
+  using SpanningTree = typename Graph<GRepr>::SpanningTree;
+  using PathCost = typename Graph<GRepr>::PathCost;
+  // Weights are kept as distances, wide enough to hold the infinity of both.
+  using Weight = typename Graph<GRepr>::Distance;
+  static constexpr Weight kInf = kWeightInf<Weight>;
+
+ public:
+  PrimEngine(std::shared_ptr<const Graph<GRepr>> g,
+             std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : g_(g),
+        tree_(std::piecewise_construct, std::forward_as_tuple(resource), std::forward_as_tuple(resource)),
+        visited_(resource),
+        Q_(resource),
+        touched_(resource) {
+    const size_t vertex_no = g->VerticesNo();
+    tree_.first.resize(vertex_no);
+    tree_.second.resize(vertex_no, kInf);
+    visited_.resize(vertex_no, false);
+    Q_.Resize(vertex_no);
+  }
+
+  // Return the (predecessors, weights) view of the spanning forest, where
+  // weights[v] is the weight of the edge (predecessors[v], v), valid until the
+  // next run. A root is its own predecessor.
+  const PathCost& Run() {
+    instrument::Disabled instr;
+    return Run(instr);
+  }
+  template <typename Instr>
+  const PathCost& Run(Instr& instr) {
+    Reset();
+    for (Vertex root = 0; root < visited_.size(); ++root)
+      if (!visited_[root] && !Grow(root, instr)) break;
+    return tree_;
+  }
+  // Run growing only the trees of [first, last) roots, the vertices of other
+  // components keep the weight kWeightInf.
+  template <typename Instr>
+  const PathCost& Run(const Vertex* first, const Vertex* last, Instr& instr) {
+    Reset();
+    for (; first != last; ++first)
+      if (!visited_[*first] && !Grow(*first, instr)) break;
+    return tree_;
+  }
+
+  // Fill the caller-owned `spanning_tree` with the edges of a new run.
+  void Run(SpanningTree& spanning_tree) {
+    instrument::Disabled instr;
+    Run(spanning_tree, instr);
+  }
+  template <typename Instr>
+  void Run(SpanningTree& spanning_tree, Instr& instr) {
+    detail::FillSpanningTree<GRepr>(Run(instr), spanning_tree);
+  }
+
+ private:
+  // Grow the tree of `root`, return false if told to stop.
+  template <typename Instr>
+  bool Grow(const Vertex root, Instr& instr) {
+    auto& [predecessors, weights] = tree_;
+    predecessors[root] = root;
+    Q_.Push(root, 0);
+    instr.HeapPush();
+    if (weights[root] == kInf) touched_.push_back(root);
+    weights[root] = 0;
+    while (!Q_.Empty()) {
+      const std::pair<Vertex, Weight> top = Q_.Pop();
+      const Vertex u = top.first;
+      instr.HeapPop();
+      visited_[u] = true;
+      if (top.second > weights[u]) {
+        instr.StaleSkip();
+        continue;
       }
+      if (instr.Stop()) return false;
+      weights[u] = top.second;
+      g_->ForEachNeighbour(u, [&](const Vertex v, const typename Graph<GRepr>::Weight weight) {
+        instr.EdgeScan();
+        if (!visited_[v] && weight < weights[v]) {
+          instr.Relaxation();
+          if (Q_.Push(v, weight))
+            instr.HeapPush();
+          else
+            instr.DecreaseKey();
+          if (weights[v] == kInf) touched_.push_back(v);
+          weights[v] = weight;
+          predecessors[v] = u;
+        }
+      });
     }
+    return true;
   }
-  auto spanning_tree = std::make_unique<std::set<WEdge>>();
-  for (Vertex v = 0; v < predecessors.size(); ++v)
-    if (v != vb) spanning_tree->emplace(Edge(predecessors[v], v), weights[v]);
+
+  void Reset() {
+    auto& [predecessors, weights] = tree_;
+    for (const Vertex v : touched_) {
+      predecessors[v] = 0;
+      weights[v] = kInf;
+      visited_[v] = false;
+    }
+    touched_.clear();
+    Q_.Clear();
+  }
+
+  std::shared_ptr<const Graph<GRepr>> g_;
+  PathCost tree_;
+  std::pmr::vector<bool> visited_;
+  Queue<Weight, Vertex> Q_;
+  std::pmr::vector<Vertex> touched_;
+};
+
+template <typename GRepr, template <typename, typename> class Queue = LazyQueue, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> HeapPrim(
+    std::shared_ptr<const Graph<GRepr>> g, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  auto spanning_tree = std::make_unique<typename Graph<GRepr>::SpanningTree>(resource);
+  PrimEngine<GRepr, Queue>(g, resource).Run(*spanning_tree, instr);
   return spanning_tree;
 }
 
+// Prim's algorithm for an AdjacencyMatrix in O(V^2) without a heap: the vertex
+// closest to the tree is found by a scan over the keys and its matrix row is
+// relaxed as a whole. When no vertex is left within reach, a new tree is grown
+// from the first vertex not in the forest yet.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> DensePrim(
+    std::shared_ptr<const Graph<GRepr>> g, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  static_assert(IsAdjacencyMatrix<GRepr>::value);
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Weight = typename Graph<GRepr>::Distance;
+  constexpr Weight kInf = kWeightInf<Weight>;
+  // Key of the vertices in the tree.
+  constexpr Weight kDone = std::numeric_limits<Weight>::lowest();
+  const GRepr& matrix = static_cast<const GRepr&>(*g);
+  const size_t vertex_no = g->VerticesNo();
+  typename Graph<GRepr>::PathCost tree(std::piecewise_construct, std::forward_as_tuple(vertex_no, resource),
+                                       std::forward_as_tuple(vertex_no, kInf, resource));
+  auto& [predecessors, weights] = tree;
+  std::pmr::vector<Weight> keys(vertex_no, kInf, resource);
+  std::pmr::vector<typename Graph<GRepr>::Weight> scratch(matrix.Dimension(), resource);
+  // Every vertex before it is in the forest.
+  size_t next_root = 0;
+  while (!instr.Stop()) {
+    auto [weight, u] = simd::ArgMin(keys.data(), vertex_no, kDone, kInf);
+    if (weight == kInf) {
+      while (next_root < vertex_no && keys[next_root] == kDone) ++next_root;
+      if (next_root == vertex_no) break;
+      weight = 0;
+      u = next_root;
+      predecessors[u] = static_cast<Vertex>(u);
+    }
+    weights[u] = weight;
+    keys[u] = kDone;
+    instr.EdgeScan(vertex_no);
+    simd::RelaxRow(matrix.Row(u, scratch.data()), vertex_no, Weight{0}, keys.data(), [&](const size_t v) {
+      instr.Relaxation();
+      predecessors[v] = static_cast<Vertex>(u);
+    });
+  }
+  auto spanning_tree = std::make_unique<typename Graph<GRepr>::SpanningTree>(resource);
+  detail::FillSpanningTree<GRepr>(tree, *spanning_tree);
+  return spanning_tree;
+}
+
+// Minimum spanning forest of a graph, with the component of every vertex.
+template <typename GRepr>
+struct SpanningForest {
+  explicit SpanningForest(std::pmr::memory_resource* resource) : edges(resource), components(resource) {}
+
+  typename Graph<GRepr>::SpanningTree edges;
+  components::Components<GRepr> components;
+};
+
+// Prim's algorithm on `threads` threads, one tree at a time each: the components
+// are found in parallel first, then dealt out largest first across the threads,
+// each of them growing the trees of its own with its own PrimEngine.
+template <typename GRepr, template <typename, typename> class Queue = LazyQueue>
+std::unique_ptr<SpanningForest<GRepr>> PrimForest(
+    std::shared_ptr<const Graph<GRepr>> g, const size_t threads = 1,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  auto forest = std::make_unique<SpanningForest<GRepr>>(resource);
+  forest->components = std::move(*components::ConnectedComponents<GRepr>(g, threads, resource));
+  const auto& ids = forest->components.ids;
+  std::vector<size_t> sizes(ids.size());
+  std::vector<Vertex> roots;
+  roots.reserve(forest->components.count);
+  for (size_t v = 0; v < ids.size(); ++v) {
+    ++sizes[ids[v]];
+    if (ids[v] == v) roots.push_back(static_cast<Vertex>(v));
+  }
+  std::stable_sort(roots.begin(), roots.end(),
+                   [&sizes](const Vertex lhs, const Vertex rhs) { return sizes[lhs] > sizes[rhs]; });
+  // The roots of the thread t, every threads-th from the t-th on. The engines
+  // allocate from `resource`, one thread only unless it is thread-safe.
+  const size_t workers =
+      sdizo::detail::IsThreadSafe(resource) ? std::max<size_t>(1, std::min(threads, roots.size())) : size_t{1};
+  std::vector<std::vector<Vertex>> shares(workers);
+  for (size_t i = 0; i < roots.size(); ++i) shares[i % workers].push_back(roots[i]);
+  std::vector<typename Graph<GRepr>::SpanningTree> trees;
+  trees.reserve(workers);
+  for (size_t t = 0; t < workers; ++t) trees.emplace_back(resource);
+  parallel::For(workers, workers, [&](size_t, const size_t begin, const size_t end) {
+    instrument::Disabled instr;
+    for (size_t t = begin; t < end; ++t) {
+      PrimEngine<GRepr, Queue> engine(g, resource);
+      const auto& share = shares[t];
+      detail::FillSpanningTree<GRepr>(engine.Run(share.data(), share.data() + share.size(), instr), trees[t]);
+    }
+  });
+  for (auto& tree : trees) forest->edges.merge(tree);
+  return forest;
+}
+
+// DensePrim for an AdjacencyMatrix, HeapPrim otherwise.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> Prim(
+    std::shared_ptr<const Graph<GRepr>> g, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  if constexpr (IsAdjacencyMatrix<GRepr>::value)
+    return DensePrim<GRepr>(g, instr, resource);
+  else
+    return HeapPrim<GRepr>(g, instr, resource);
+}
+
+template <typename GRepr>
+std::unique_ptr<typename Graph<GRepr>::SpanningTree> Prim(std::shared_ptr<const Graph<GRepr>> g) {
+  instrument::Disabled instr;
+  return Prim<GRepr>(g, instr);
+}
+
 }  // namespace sdizo::mst
 
 #endif  // SDIZO_MST_HPP_
@@ -0,0 +1,97 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_OUTPUT_HPP_
+#define SDIZO_OUTPUT_HPP_
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace sdizo::output {
+
+// Append the decimal `value` to `out`.
+template <typename T>
+void Append(std::string& out, const T value) {
+  char buffer[24];
+  const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, end);
+}
+
+// Buffered writer of a stream. Numbers are formatted by std::to_chars straight
+// into a large buffer, reserved but not filled up front, handed to the stream in
+// one call when full or on Flush() and destruction. The stream itself is never
+// flushed, a writer to stdout keeps the order of the printf() calls around it.
+class Writer {
+ public:
+  static constexpr size_t kCapacity = 1 << 20;
+
+  explicit Writer(FILE* fp = stdout) : fp_(fp) { buffer_.reserve(kCapacity); }
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+  ~Writer() { Flush(); }
+
+  Writer& Char(const char c) {
+    if (buffer_.size() == kCapacity) Flush();
+    buffer_.push_back(c);
+    return *this;
+  }
+  Writer& Text(const std::string_view text) { return Bytes(text.data(), text.size()); }
+  // The decimal `value` right-aligned to `width` characters, like "%*d".
+  template <typename T>
+  Writer& Number(const T value, const size_t width = 0) {
+    char digits[24];
+    const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    const size_t length = end - digits;
+    for (size_t i = length; i < width; ++i) Char(' ');
+    return Bytes(digits, length);
+  }
+  Writer& Bytes(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+      if (buffer_.size() == kCapacity) Flush();
+      const size_t chunk = std::min(size, kCapacity - buffer_.size());
+      buffer_.append(bytes, chunk);
+      bytes += chunk;
+      size -= chunk;
+    }
+    return *this;
+  }
+  // Binary `value` in the byte order of the machine.
+  template <typename T>
+  Writer& Raw(const T value) {
+    return Bytes(&value, sizeof(value));
+  }
+
+  // Hand the buffered bytes to the stream, false if it failed at any point.
+  bool Flush() {
+    if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), fp_) != buffer_.size()) failed_ = true;
+    buffer_.clear();
+    return !failed_;
+  }
+
+ private:
+  FILE* fp_;
+  std::string buffer_;
+  bool failed_{false};
+};
+
+}  // namespace sdizo::output
+
+#endif  // SDIZO_OUTPUT_HPP_
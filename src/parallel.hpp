@@ -0,0 +1,46 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_PARALLEL_HPP_
+#define SDIZO_PARALLEL_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace sdizo::parallel {
+
+// Split [0, n) into at most `threads` contiguous chunks and call
+// fn(chunk, begin, end) for each of them concurrently. The calling thread runs
+// the first chunk itself.
+template <typename Fn>
+void For(size_t threads, const size_t n, Fn fn) {
+  threads = std::max<size_t>(1, std::min(threads, n));
+  const size_t chunk = (n + threads - 1) / std::max<size_t>(threads, 1);
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (size_t t = 1; t < threads; ++t) {
+    const size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+    workers.emplace_back([&fn, t, begin, end] { fn(t, begin, end); });
+  }
+  fn(size_t{0}, size_t{0}, std::min(n, chunk));
+  for (std::thread& worker : workers) worker.join();
+}
+
+}  // namespace sdizo::parallel
+
+#endif  // SDIZO_PARALLEL_HPP_
@@ -14,16 +14,31 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <sys/utsname.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include "args.hpp"
+#include "compressed.hpp"
+#include "dheap.hpp"
 #include "graph.hpp"
 #include "graphgenerator.hpp"
 #include "graphtype.hpp"
+#include "instrument.hpp"
 #include "mst.hpp"
 #include "shortestpath.hpp"
 #include "test.hpp"
@@ -33,6 +48,10 @@ namespace {
 namespace config {
 
 constexpr size_t kRepetitions = 100;
+// Significance level of the regression test against a baseline.
+constexpr double kAlpha = 0.01;
+// Default slowdown, in percent, which fails the comparison against a baseline.
+constexpr double kThreshold = 5.;
 static constexpr std::array<size_t, 4> kDensities = {{25, 50, 75, 99}};
 static constexpr std::array<size_t, 5> kVertices = {{50, 150, 200, 250, 300}};
 
@@ -42,9 +61,15 @@ enum class TestObj {
   kKruskalList,
   kKruskalMatrix,
   kPrimList,
+  kPrimListDHeap,
   kPrimMatrix,
+  kPrimMatrixHeap,
+  kPrimCompressed,
   kDijkstraList,
+  kDijkstraListDHeap,
   kDijkstraMatrix,
+  kDijkstraMatrixHeap,
+  kDijkstraCompressed,
   kBellmanFordList,
   kBellmanFordMatrix,
 };
@@ -57,12 +82,24 @@ const char* Label(const TestObj test_obj) {
       return "Kruskal Matrix";
     case TestObj::kPrimList:
       return "Prim List";
+    case TestObj::kPrimListDHeap:
+      return "Prim List(dheap)";
     case TestObj::kPrimMatrix:
       return "Prim Matrix";
+    case TestObj::kPrimMatrixHeap:
+      return "Prim Matrix(heap)";
+    case TestObj::kPrimCompressed:
+      return "Prim Compressed";
     case TestObj::kDijkstraList:
       return "Dijkstra List";
+    case TestObj::kDijkstraListDHeap:
+      return "Dijkstra List(dheap)";
     case TestObj::kDijkstraMatrix:
       return "Dijkstra Matrix";
+    case TestObj::kDijkstraMatrixHeap:
+      return "Dijkstra Matrix(heap)";
+    case TestObj::kDijkstraCompressed:
+      return "Dijkstra Compressed";
     case TestObj::kBellmanFordList:
       return "BellmanFord List";
     case TestObj::kBellmanFordMatrix:
@@ -74,35 +111,217 @@ const char* Label(const TestObj test_obj) {
 
 class MeasureObjs {
  public:
+  using Samples = std::vector<int64_t>;
+
   MeasureObjs() { Reset(); }
 
-  int64_t& operator[](const TestObj test_obj) { return measures_[test_obj]; }
-  MeasureObjs& operator++() {
-    ++cnt_;
-    return *this;
-  }
+  Samples& operator[](const TestObj test_obj) { return samples_[test_obj]; }
 
   auto Avg() const {
     std::map<TestObj, double> avg;
-    for (const auto& [test_obj, total_time] : measures_) avg[test_obj] = total_time / static_cast<double>(cnt_);
+    for (const auto& [test_obj, samples] : samples_)
+      avg[test_obj] = std::accumulate(samples.cbegin(), samples.cend(), 0.) / samples.size();
     return avg;
   }
 
+  const std::map<TestObj, Samples>& All() const { return samples_; }
+
+  void Reset() {
+    samples_[TestObj::kKruskalList].clear();
+    samples_[TestObj::kKruskalMatrix].clear();
+    samples_[TestObj::kPrimList].clear();
+    samples_[TestObj::kPrimListDHeap].clear();
+    samples_[TestObj::kPrimMatrix].clear();
+    samples_[TestObj::kPrimMatrixHeap].clear();
+    samples_[TestObj::kPrimCompressed].clear();
+    samples_[TestObj::kDijkstraList].clear();
+    samples_[TestObj::kDijkstraListDHeap].clear();
+    samples_[TestObj::kDijkstraMatrix].clear();
+    samples_[TestObj::kDijkstraMatrixHeap].clear();
+    samples_[TestObj::kDijkstraCompressed].clear();
+    samples_[TestObj::kBellmanFordList].clear();
+    samples_[TestObj::kBellmanFordMatrix].clear();
+  }
+
+ private:
+  std::map<TestObj, Samples> samples_;
+};
+
+// One-sided Mann-Whitney U test, with the normal approximation and the tie
+// correction. Return the p-value of the hypothesis that `current` samples are
+// stochastically greater (slower) than the `baseline` ones.
+double MannWhitneyGreater(const std::vector<int64_t>& current, const std::vector<int64_t>& baseline) {
+  const double n1 = current.size(), n2 = baseline.size(), n = n1 + n2;
+  if (n1 == 0 || n2 == 0) return 1.;
+  std::vector<std::pair<int64_t, bool>> all;  // (sample, is current)
+  all.reserve(current.size() + baseline.size());
+  for (const int64_t sample : current) all.emplace_back(sample, true);
+  for (const int64_t sample : baseline) all.emplace_back(sample, false);
+  std::sort(all.begin(), all.end());
+  double rank_sum = 0., ties = 0.;
+  for (size_t i = 0, j; i < all.size(); i = j) {
+    for (j = i + 1; j < all.size() && all[j].first == all[i].first; ++j) {
+    }
+    const double t = j - i, rank = (i + 1 + j) / 2.;
+    ties += t * t * t - t;
+    for (size_t k = i; k < j; ++k)
+      if (all[k].second) rank_sum += rank;
+  }
+  const double u = rank_sum - n1 * (n1 + 1) / 2.;
+  const double sigma = std::sqrt(n1 * n2 / 12. * ((n + 1) - ties / (n * (n - 1))));
+  if (sigma == 0.) return 1.;
+  const double z = (u - n1 * n2 / 2. - 0.5) / sigma;
+  return 0.5 * std::erfc(z / std::sqrt(2.));
+}
+
+double Median(std::vector<int64_t> samples) {
+  if (samples.empty()) return 0.;
+  const size_t mid = samples.size() / 2;
+  std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+  if (samples.size() % 2) return samples[mid];
+  return (samples[mid] + *std::max_element(samples.begin(), samples.begin() + mid)) / 2.;
+}
+
+// Timing samples of all cells, (algorithm, representation, vertices, density),
+// of a run. Saved after the run and loaded as the baseline of another one.
+class Results {
+ public:
+  using Key = std::tuple<std::string, std::string, size_t, size_t>;
+
+  void Add(const TestObj test_obj, const size_t vertices, const size_t density, const MeasureObjs::Samples& samples) {
+    const std::string label = Label(test_obj);
+    const size_t space = label.find(' ');
+    cells_[Key(label.substr(0, space), label.substr(space + 1), vertices, density)] = samples;
+  }
+
+  const MeasureObjs::Samples* Find(const TestObj test_obj, const size_t vertices, const size_t density) const {
+    const std::string label = Label(test_obj);
+    const size_t space = label.find(' ');
+    auto it = cells_.find(Key(label.substr(0, space), label.substr(space + 1), vertices, density));
+    return it != cells_.end() ? &it->second : nullptr;
+  }
+
+  const std::vector<std::string>& Tags() const { return tags_; }
+
+  bool Load(const char* path) {
+    FILE* fp = std::fopen(path, "r");
+    if (fp == nullptr) {
+      std::fprintf(stderr, "Error: Open file path=[%s], errno=%d\n", path, errno);
+      return false;
+    }
+    char algorithm[64], representation[64];
+    size_t vertices, density, n;
+    char line[1024];
+    bool result = true;
+    while (result) {
+      const int c = std::fgetc(fp);
+      if (c == EOF) break;
+      if (c == '#') {
+        if (std::fgets(line, sizeof(line), fp) == nullptr) break;
+        line[std::strcspn(line, "\n")] = '\0';
+        tags_.emplace_back(line[0] == ' ' ? line + 1 : line);
+        continue;
+      }
+      std::ungetc(c, fp);
+      if (std::fscanf(fp, "%63s %63s %zu %zu %zu", algorithm, representation, &vertices, &density, &n) != 5) {
+        result = false;
+        break;
+      }
+      auto& samples = cells_[Key(algorithm, representation, vertices, density)];
+      samples.resize(n);
+      for (int64_t& sample : samples)
+        if (std::fscanf(fp, "%" SCNd64, &sample) != 1) result = false;
+      std::fscanf(fp, " ");
+    }
+    std::fclose(fp);
+    if (!result) std::fprintf(stderr, "Error: Malformed results file path=[%s]\n", path);
+    return result;
+  }
+
+  bool Save(const char* path) const {
+    FILE* fp = std::fopen(path, "w");
+    if (fp == nullptr) {
+      std::fprintf(stderr, "Error: Open file path=[%s], errno=%d\n", path, errno);
+      return false;
+    }
+    for (const std::string& tag : BuildTags()) std::fprintf(fp, "# %s\n", tag.c_str());
+    for (const auto& [key, samples] : cells_) {
+      const auto& [algorithm, representation, vertices, density] = key;
+      std::fprintf(fp, "%s %s %zu %zu %zu", algorithm.c_str(), representation.c_str(), vertices, density,
+                   samples.size());
+      for (const int64_t sample : samples) std::fprintf(fp, " %" PRId64, sample);
+      std::fputc('\n', fp);
+    }
+    return std::fclose(fp) == 0;
+  }
+
+ private:
+  // Describe the build and the host the results come from.
+  static std::vector<std::string> BuildTags() {
+    std::vector<std::string> tags;
+    tags.push_back(std::string("sdizograph perf results"));
+#ifdef NDEBUG
+    tags.push_back(std::string("build compiler=") + __VERSION__ + " assertions=off");
+#else
+    tags.push_back(std::string("build compiler=") + __VERSION__ + " assertions=on");
+#endif
+    char hostname[256] = "unknown";
+    ::gethostname(hostname, sizeof(hostname) - 1);
+    struct utsname uts;
+    std::string host = std::string("host name=") + hostname;
+    if (::uname(&uts) == 0) host += std::string(" system=") + uts.sysname + " " + uts.release + " " + uts.machine;
+    host += " cores=" + std::to_string(std::thread::hardware_concurrency());
+    tags.push_back(host);
+    if (FILE* fp = std::fopen("/proc/cpuinfo", "r"); fp != nullptr) {
+      char line[512];
+      while (std::fgets(line, sizeof(line), fp) != nullptr)
+        if (std::strncmp(line, "model name", 10) == 0) {
+          const char* model = std::strchr(line, ':');
+          line[std::strcspn(line, "\n")] = '\0';
+          if (model != nullptr) tags.push_back(std::string("cpu") + (model + 1));
+          break;
+        }
+      std::fclose(fp);
+    }
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    tags.push_back(std::string("date ") + date);
+    return tags;
+  }
+
+  std::map<Key, MeasureObjs::Samples> cells_;
+  std::vector<std::string> tags_;
+};
+
+// Average internal work per test object, collected outside of the timed runs.
+class CountObjs {
+ public:
+  instrument::Enabled& operator[](const TestObj test_obj) { return counters_[test_obj]; }
+  CountObjs& operator++() {
+    ++cnt_;
+    return *this;
+  }
+
+  void Print() const {
+    for (const auto& [test_obj, counters] : counters_)
+      std::printf("  %-21s: edge_scans= %10.1f relaxations= %10.1f heap_pushes= %9.1f heap_pops= %9.1f "
+                  "decrease_keys= %9.1f stale_skips= %9.1f rounds= %6.1f finds= %9.1f unions= %7.1f\n",
+                  Label(test_obj), Avg(counters.edge_scans), Avg(counters.relaxations), Avg(counters.heap_pushes),
+                  Avg(counters.heap_pops), Avg(counters.decrease_keys), Avg(counters.stale_skips),
+                  Avg(counters.rounds), Avg(counters.finds), Avg(counters.unions));
+  }
+
   void Reset() {
     cnt_ = 0;
-    measures_[TestObj::kKruskalList] = 0;
-    measures_[TestObj::kKruskalMatrix] = 0;
-    measures_[TestObj::kPrimList] = 0;
-    measures_[TestObj::kPrimMatrix] = 0;
-    measures_[TestObj::kDijkstraList] = 0;
-    measures_[TestObj::kDijkstraMatrix] = 0;
-    measures_[TestObj::kBellmanFordList] = 0;
-    measures_[TestObj::kBellmanFordMatrix] = 0;
+    counters_.clear();
   }
 
  private:
+  double Avg(const uint64_t total) const { return cnt_ ? total / static_cast<double>(cnt_) : 0.; }
+
   size_t cnt_{0};
-  std::map<TestObj, int64_t> measures_;
+  std::map<TestObj, instrument::Enabled> counters_;
 };
 
 template <typename Fn>
@@ -113,59 +332,134 @@ int64_t MeasureNs(Fn op) {
   return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
 }
 
-void MeasureMst(GraphGenerator& graph_gen, const size_t vertices, const size_t density, MeasureObjs& measure) {
+void MeasureMst(GraphGenerator& graph_gen, const size_t vertices, const size_t density, MeasureObjs& measure,
+               CountObjs* count) {
   auto edges = graph_gen.Generate(vertices, density, false);
-  auto g_matrix = std::make_shared<AdjacencyMatrix>(false, vertices);
-  auto g_list = std::make_shared<AdjacencyList>(false, vertices);
-  std::for_each(edges.cbegin(), edges.cend(), [&g_list, &g_matrix](const WEdge& edge) {
-    g_list->AddEdge(edge);
-    g_matrix->AddEdge(edge);
-  });
-  measure[TestObj::kKruskalList] += MeasureNs([&g_list] { mst::Kruskal<AdjacencyList>(g_list); });
-  measure[TestObj::kKruskalMatrix] += MeasureNs([&g_matrix] { mst::Kruskal<AdjacencyMatrix>(g_matrix); });
-  measure[TestObj::kPrimList] += MeasureNs([&g_list] { mst::Prim<AdjacencyList>(g_list); });
-  measure[TestObj::kPrimMatrix] += MeasureNs([&g_matrix] { mst::Prim<AdjacencyMatrix>(g_matrix); });
+  auto g_matrix = std::make_shared<UndirectedMatrix>(vertices);
+  auto g_list = std::make_shared<UndirectedList>(vertices);
+  auto g_compressed = std::make_shared<UndirectedCompressed>(vertices);
+  g_list->AddEdges(edges);
+  g_matrix->AddEdges(edges);
+  g_compressed->AddEdges(edges);
+  measure[TestObj::kKruskalList].push_back(MeasureNs([&g_list] { mst::Kruskal<UndirectedList>(g_list); }));
+  measure[TestObj::kKruskalMatrix].push_back(MeasureNs([&g_matrix] { mst::Kruskal<UndirectedMatrix>(g_matrix); }));
+  measure[TestObj::kPrimList].push_back(MeasureNs([&g_list] { mst::Prim<UndirectedList>(g_list); }));
+  measure[TestObj::kPrimListDHeap].push_back(MeasureNs([&g_list] {
+    instrument::Disabled instr;
+    mst::HeapPrim<UndirectedList, IndexedQueue>(g_list, instr);
+  }));
+  measure[TestObj::kPrimMatrix].push_back(MeasureNs([&g_matrix] { mst::Prim<UndirectedMatrix>(g_matrix); }));
+  measure[TestObj::kPrimMatrixHeap].push_back(MeasureNs([&g_matrix] {
+    instrument::Disabled instr;
+    mst::HeapPrim<UndirectedMatrix>(g_matrix, instr);
+  }));
+  measure[TestObj::kPrimCompressed].push_back(
+      MeasureNs([&g_compressed] { mst::Prim<UndirectedCompressed>(g_compressed); }));
+  if (count == nullptr) return;
+  mst::Kruskal<UndirectedList>(g_list, (*count)[TestObj::kKruskalList]);
+  mst::Kruskal<UndirectedMatrix>(g_matrix, (*count)[TestObj::kKruskalMatrix]);
+  mst::Prim<UndirectedList>(g_list, (*count)[TestObj::kPrimList]);
+  mst::HeapPrim<UndirectedList, IndexedQueue>(g_list, (*count)[TestObj::kPrimListDHeap]);
+  mst::Prim<UndirectedMatrix>(g_matrix, (*count)[TestObj::kPrimMatrix]);
+  mst::HeapPrim<UndirectedMatrix>(g_matrix, (*count)[TestObj::kPrimMatrixHeap]);
+  mst::Prim<UndirectedCompressed>(g_compressed, (*count)[TestObj::kPrimCompressed]);
 }
 
-void MeasureShortestPath(GraphGenerator& graph_gen, const size_t vertices, const size_t density, MeasureObjs& measure) {
+void MeasureShortestPath(GraphGenerator& graph_gen, const size_t vertices, const size_t density, MeasureObjs& measure,
+                         CountObjs* count) {
   Vertex vb;
   auto edges_d = graph_gen.Generate(vertices, density, true, &vb);
-  auto g_matrix_d = std::make_shared<AdjacencyMatrix>(true);
-  auto g_list_d = std::make_shared<AdjacencyList>(true);
-  std::for_each(edges_d.cbegin(), edges_d.cend(), [&g_list_d, &g_matrix_d](const WEdge& edge) {
-    g_list_d->AddEdge(edge);
-    g_matrix_d->AddEdge(edge);
-  });
-  measure[TestObj::kDijkstraList] +=
-      MeasureNs([&g_list_d, &vb] { shortestpath::Dijkstra<AdjacencyList>(g_list_d, vb); });
-  measure[TestObj::kDijkstraMatrix] +=
-      MeasureNs([&g_matrix_d, &vb] { shortestpath::Dijkstra<AdjacencyMatrix>(g_matrix_d, vb); });
-  measure[TestObj::kBellmanFordList] +=
-      MeasureNs([&g_list_d, &vb] { shortestpath::BellmanFord<AdjacencyList>(g_list_d, vb); });
-  measure[TestObj::kBellmanFordMatrix] +=
-      MeasureNs([&g_matrix_d, &vb] { shortestpath::BellmanFord<AdjacencyMatrix>(g_matrix_d, vb); });
+  auto g_matrix_d = std::make_shared<DirectedMatrix>(vertices);
+  auto g_list_d = std::make_shared<DirectedList>(vertices);
+  auto g_compressed_d = std::make_shared<DirectedCompressed>(vertices);
+  g_list_d->AddEdges(edges_d);
+  g_matrix_d->AddEdges(edges_d);
+  g_compressed_d->AddEdges(edges_d);
+  measure[TestObj::kDijkstraList].push_back(
+      MeasureNs([&g_list_d, &vb] { shortestpath::Dijkstra<DirectedList>(g_list_d, vb); }));
+  measure[TestObj::kDijkstraListDHeap].push_back(MeasureNs([&g_list_d, &vb] {
+    instrument::Disabled instr;
+    shortestpath::HeapDijkstra<DirectedList, IndexedQueue>(g_list_d, vb, instr);
+  }));
+  measure[TestObj::kDijkstraMatrix].push_back(
+      MeasureNs([&g_matrix_d, &vb] { shortestpath::Dijkstra<DirectedMatrix>(g_matrix_d, vb); }));
+  measure[TestObj::kDijkstraMatrixHeap].push_back(MeasureNs([&g_matrix_d, &vb] {
+    instrument::Disabled instr;
+    shortestpath::HeapDijkstra<DirectedMatrix>(g_matrix_d, vb, instr);
+  }));
+  measure[TestObj::kDijkstraCompressed].push_back(
+      MeasureNs([&g_compressed_d, &vb] { shortestpath::Dijkstra<DirectedCompressed>(g_compressed_d, vb); }));
+  measure[TestObj::kBellmanFordList].push_back(
+      MeasureNs([&g_list_d, &vb] { shortestpath::BellmanFord<DirectedList>(g_list_d, vb); }));
+  measure[TestObj::kBellmanFordMatrix].push_back(
+      MeasureNs([&g_matrix_d, &vb] { shortestpath::BellmanFord<DirectedMatrix>(g_matrix_d, vb); }));
+  if (count == nullptr) return;
+  shortestpath::Dijkstra<DirectedList>(g_list_d, vb, (*count)[TestObj::kDijkstraList]);
+  shortestpath::HeapDijkstra<DirectedList, IndexedQueue>(g_list_d, vb, (*count)[TestObj::kDijkstraListDHeap]);
+  shortestpath::Dijkstra<DirectedMatrix>(g_matrix_d, vb, (*count)[TestObj::kDijkstraMatrix]);
+  shortestpath::HeapDijkstra<DirectedMatrix>(g_matrix_d, vb, (*count)[TestObj::kDijkstraMatrixHeap]);
+  shortestpath::Dijkstra<DirectedCompressed>(g_compressed_d, vb, (*count)[TestObj::kDijkstraCompressed]);
+  shortestpath::BellmanFord<DirectedList>(g_list_d, vb, (*count)[TestObj::kBellmanFordList]);
+  shortestpath::BellmanFord<DirectedMatrix>(g_matrix_d, vb, (*count)[TestObj::kBellmanFordMatrix]);
 }
 
 }  // namespace
 
 bool Performance(const util::Args& args) {
   GraphGenerator graph_gen(args.IsFlag("random"));
+  size_t repetitions = config::kRepetitions;
+  if (const char* value = args.GetValue("repetitions"); value != nullptr)
+    repetitions = std::strtoull(value, nullptr, 10);
+  if (repetitions == 0) repetitions = config::kRepetitions;
+  double threshold = config::kThreshold;
+  if (const char* value = args.GetValue("threshold"); value != nullptr) threshold = std::strtod(value, nullptr);
+  Results baseline;
+  const bool compare = args.IsOption("baseline");
+  if (compare) {
+    if (!baseline.Load(args.GetValue("baseline"))) return false;
+    for (const std::string& tag : baseline.Tags()) std::printf("Baseline: %s\n", tag.c_str());
+  }
+  Results results;
+  size_t regressions = 0;
   MeasureObjs measure;
+  // Counted runs are separate from the timed ones, so enabling them does not skew the times.
+  CountObjs count_objs;
+  CountObjs* count = args.IsFlag("counters") ? &count_objs : nullptr;
   for (const size_t vertices : config::kVertices) {
     for (const size_t density : config::kDensities) {
       measure.Reset();
-      for (size_t rep = 0; rep < config::kRepetitions; ++rep) {
-        MeasureMst(graph_gen, vertices, density, measure);
-        MeasureShortestPath(graph_gen, vertices, density, measure);
-        ++measure;
+      count_objs.Reset();
+      for (size_t rep = 0; rep < repetitions; ++rep) {
+        MeasureMst(graph_gen, vertices, density, measure, count);
+        MeasureShortestPath(graph_gen, vertices, density, measure, count);
+        ++count_objs;
       }
       std::printf("vertices= %3zu density= %2zu", vertices, density);
       auto avg = measure.Avg();
-      for (const auto& [test_obj, value] : avg) std::printf(" | %-18s= %11.2f", Label(test_obj), value);
+      for (const auto& [test_obj, value] : avg) std::printf(" | %-21s= %11.2f", Label(test_obj), value);
       std::putchar('\n');
+      if (count != nullptr) count->Print();
+      for (const auto& [test_obj, samples] : measure.All()) {
+        results.Add(test_obj, vertices, density, samples);
+        if (!compare) continue;
+        const MeasureObjs::Samples* base = baseline.Find(test_obj, vertices, density);
+        if (base == nullptr) {
+          std::printf("  %-21s: missing in the baseline\n", Label(test_obj));
+          continue;
+        }
+        const double slowdown = (Median(samples) / Median(*base) - 1.) * 100.;
+        const double p = MannWhitneyGreater(samples, *base);
+        const bool regression = p < config::kAlpha && slowdown > threshold;
+        regressions += regression;
+        std::printf("  %-21s: median %+7.2f%% p= %.4f%s\n", Label(test_obj), slowdown, p,
+                    regression ? " REGRESSION" : "");
+      }
     }
   }
-  return true;
+  if (const char* path = args.GetValue("save"); path != nullptr && !results.Save(path)) return false;
+  if (compare)
+    std::printf("Regressions: %zu (threshold= %.2f%%, alpha= %.2f)\n", regressions, threshold, config::kAlpha);
+  return regressions == 0;
 }
 
 }  // namespace sdizo::test
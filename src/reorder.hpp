@@ -0,0 +1,170 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_REORDER_HPP_
+#define SDIZO_REORDER_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "graph.hpp"
+
+namespace sdizo::reorder {
+
+// Vertex orderings placing the vertices visited together close to each other.
+enum class Ordering {
+  kNone,    // Identity.
+  kBfs,     // Breadth-first order, the components one after another.
+  kDegree,  // Descending degree, the hubs first.
+  kRcm,     // Reverse Cuthill-McKee, a BFS from a low-degree vertex visiting the lower degree neighbours first,
+            // reversed. Keeps the non-zeros of the adjacency matrix close to the diagonal.
+};
+
+// Relabelling of the vertices: a vertex `v` becomes to_new[v], to_old maps the
+// new ids back.
+template <typename V>
+struct Permutation {
+  explicit Permutation(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : to_new(resource), to_old(resource) {}
+
+  size_t size() const { return to_new.size(); }
+
+  // Permutation mapping the new ids back to the old ones.
+  Permutation Inverse() const {
+    Permutation inverse(to_new.get_allocator().resource());
+    inverse.to_new = to_old;
+    inverse.to_old = to_new;
+    return inverse;
+  }
+
+  std::pmr::vector<V> to_new;
+  std::pmr::vector<V> to_old;
+};
+
+// Compute the `ordering` of the vertices of `g`. For a directed graph the
+// traversals follow the outgoing arcs.
+template <typename GRepr>
+std::unique_ptr<Permutation<typename Graph<GRepr>::Vertex>> ComputeOrdering(
+    std::shared_ptr<const Graph<GRepr>> g, const Ordering ordering,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  const size_t vertex_no = g->VerticesNo();
+  const auto adjacents = g->Adj();
+  auto permutation = std::make_unique<Permutation<Vertex>>(resource);
+  auto& order = permutation->to_old;  // Old ids in the new order.
+  order.resize(vertex_no);
+  std::iota(order.begin(), order.end(), Vertex{0});
+  std::pmr::vector<size_t> degrees(vertex_no, resource);
+  for (size_t v = 0; v < vertex_no; ++v) degrees[v] = (*adjacents)[v].size();
+  const auto by_degree = [&degrees](const Vertex lhs, const Vertex rhs) -> bool { return degrees[lhs] < degrees[rhs]; };
+  switch (ordering) {
+    case Ordering::kNone:
+      break;
+    case Ordering::kDegree:
+      std::stable_sort(order.begin(), order.end(),
+                       [&degrees](const Vertex lhs, const Vertex rhs) -> bool { return degrees[lhs] > degrees[rhs]; });
+      break;
+    case Ordering::kBfs:
+    case Ordering::kRcm: {
+      const bool rcm = ordering == Ordering::kRcm;
+      // Roots of the traversals in the order they are tried.
+      std::pmr::vector<Vertex> roots(order, resource);
+      if (rcm) std::stable_sort(roots.begin(), roots.end(), by_degree);
+      std::pmr::vector<bool> visited(vertex_no, false, resource);
+      std::pmr::vector<Vertex> neighbours(resource);
+      // `order` is the queue of the traversal, filled up to `tail`.
+      size_t tail = 0;
+      for (const Vertex root : roots) {
+        if (visited[root]) continue;
+        visited[root] = true;
+        order[tail++] = root;
+        for (size_t head = tail - 1; head < tail; ++head) {
+          neighbours.clear();
+          for (const auto& connection : (*adjacents)[order[head]])
+            if (!visited[connection.first]) {
+              visited[connection.first] = true;
+              neighbours.push_back(connection.first);
+            }
+          if (rcm) std::stable_sort(neighbours.begin(), neighbours.end(), by_degree);
+          std::copy(neighbours.cbegin(), neighbours.cend(), order.begin() + tail);
+          tail += neighbours.size();
+        }
+      }
+      if (rcm) std::reverse(order.begin(), order.end());
+      break;
+    }
+  }
+  permutation->to_new.resize(vertex_no);
+  for (size_t i = 0; i < vertex_no; ++i) permutation->to_new[order[i]] = static_cast<Vertex>(i);
+  return permutation;
+}
+
+// Copy of `g` with the vertices relabelled by `permutation`, in the same memory
+// resource.
+template <typename GRepr>
+std::shared_ptr<GRepr> Relabel(std::shared_ptr<const Graph<GRepr>> g,
+                               const Permutation<typename Graph<GRepr>::Vertex>& permutation) {
+  using WEdge = typename Graph<GRepr>::WEdge;
+  const auto& to_new = permutation.to_new;
+  auto edges = g->Edges();
+  if constexpr (!GRepr::kIsDirected && !IsAdjacencyMatrix<GRepr>::value) {
+    // The undirected list yields every edge in both directions, a self-loop is
+    // added back as stored.
+    const auto mirrored = [](const WEdge& wedge) -> bool { return wedge.first.first > wedge.first.second; };
+    edges->erase(std::remove_if(edges->begin(), edges->end(), mirrored), edges->end());
+  }
+  for (WEdge& wedge : *edges) wedge.first = {to_new[wedge.first.first], to_new[wedge.first.second]};
+  auto relabelled = std::make_shared<GRepr>(g->VerticesNo(), g->Resource());
+  relabelled->AddEdges(*edges);
+  return relabelled;
+}
+
+// Map the ids of the (predecessors, distances) computed on the relabelled graph
+// back to the ids of the original one. The vertices not reached keep the
+// predecessor 0.
+template <typename V, typename D>
+void Restore(std::pair<std::pmr::vector<V>, std::pmr::vector<D>>& path_cost, const Permutation<V>& permutation) {
+  auto& [predecessors, distances] = path_cost;
+  std::pmr::vector<V> old_predecessors(predecessors.size(), predecessors.get_allocator().resource());
+  std::pmr::vector<D> old_distances(distances.size(), distances.get_allocator().resource());
+  for (size_t v = 0; v < predecessors.size(); ++v) {
+    const V u = permutation.to_new[v];
+    old_distances[v] = distances[u];
+    if (distances[u] != std::numeric_limits<D>::max()) old_predecessors[v] = permutation.to_old[predecessors[u]];
+  }
+  predecessors = std::move(old_predecessors);
+  distances = std::move(old_distances);
+}
+
+// Map the ids of the spanning tree computed on the relabelled graph back to the
+// ids of the original one.
+template <typename V, typename W>
+void Restore(std::pmr::set<std::pair<std::pair<V, V>, W>>& spanning_tree, const Permutation<V>& permutation) {
+  std::pmr::set<std::pair<std::pair<V, V>, W>> old_tree(spanning_tree.get_allocator().resource());
+  for (const auto& [edge, weight] : spanning_tree)
+    old_tree.emplace(std::make_pair(permutation.to_old[edge.first], permutation.to_old[edge.second]), weight);
+  spanning_tree = std::move(old_tree);
+}
+
+}  // namespace sdizo::reorder
+
+#endif  // SDIZO_REORDER_HPP_
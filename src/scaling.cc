@@ -0,0 +1,256 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include "args.hpp"
+#include "components.hpp"
+#include "graph.hpp"
+#include "graphgenerator.hpp"
+#include "graphtype.hpp"
+#include "mst.hpp"
+#include "shortestpath.hpp"
+#include "test.hpp"
+
+namespace sdizo::test {
+namespace {
+namespace config {
+
+constexpr size_t kMinVertices = 1 << 12;
+constexpr size_t kGrowth = 4;
+constexpr size_t kMaxVertices = 1 << 20;
+constexpr size_t kBudgetMs = 1000;
+static constexpr std::array<size_t, 4> kDegrees = {{4, 8, 16, 32}};
+// Sizes at which a single run is predicted to take longer than this many
+// budgets are skipped.
+constexpr size_t kOverrun = 16;
+// Rough size of a single std::list node holding a Connection, allocator
+// overhead included.
+constexpr size_t kListNodeBytes = 48;
+
+}  // namespace config
+
+struct Options {
+  size_t max_vertices{config::kMaxVertices};
+  double budget_s{config::kBudgetMs / 1e3};
+  size_t threads{1};
+  size_t mem_cap{0};  // In bytes.
+};
+
+enum class Repr { kList, kMatrix };
+
+struct Graphs {
+  std::shared_ptr<UndirectedList> list;
+  std::shared_ptr<UndirectedMatrix> matrix;
+  std::shared_ptr<DirectedList> list_d;
+  std::shared_ptr<DirectedMatrix> matrix_d;
+  std::vector<WEdge> edges;
+  std::vector<WEdge> edges_d;
+  size_t vertices;
+  Vertex vb;
+};
+
+struct Algorithm {
+  const char* label;
+  Repr repr;
+  bool directed;
+  // Whether the algorithm uses the `threads` argument, only parallel algorithms
+  // are swept over the thread counts.
+  bool parallel;
+  std::function<void(const Graphs&, size_t threads)> run;
+};
+
+const std::vector<Algorithm>& Algorithms() {
+  static const std::vector<Algorithm> algorithms = {
+      {"Build List", Repr::kList, false, false,
+       [](const Graphs& g, size_t) {
+         UndirectedList list(g.vertices);
+         for (const WEdge& edge : g.edges) list.AddEdge(edge);
+       }},
+      {"Build List (bulk)", Repr::kList, false, true,
+       [](const Graphs& g, const size_t threads) {
+         UndirectedList list(g.vertices);
+         list.AddEdges(g.edges, Duplicates::kKeep, threads);
+       }},
+      {"Components List", Repr::kList, false, true,
+       [](const Graphs& g, const size_t threads) { components::ConnectedComponents<UndirectedList>(g.list, threads); }},
+      {"Kruskal List", Repr::kList, false, false,
+       [](const Graphs& g, size_t) { mst::Kruskal<UndirectedList>(g.list); }},
+      {"Kruskal Matrix", Repr::kMatrix, false, false,
+       [](const Graphs& g, size_t) { mst::Kruskal<UndirectedMatrix>(g.matrix); }},
+      {"Prim List", Repr::kList, false, false, [](const Graphs& g, size_t) { mst::Prim<UndirectedList>(g.list); }},
+      {"Prim Matrix", Repr::kMatrix, false, false,
+       [](const Graphs& g, size_t) { mst::Prim<UndirectedMatrix>(g.matrix); }},
+      {"Prim Forest List", Repr::kList, false, true,
+       [](const Graphs& g, const size_t threads) { mst::PrimForest<UndirectedList>(g.list, threads); }},
+      {"Dijkstra List", Repr::kList, true, false,
+       [](const Graphs& g, size_t) { shortestpath::Dijkstra<DirectedList>(g.list_d, g.vb); }},
+      {"Dijkstra Matrix", Repr::kMatrix, true, false,
+       [](const Graphs& g, size_t) { shortestpath::Dijkstra<DirectedMatrix>(g.matrix_d, g.vb); }},
+      {"BellmanFord List", Repr::kList, true, false,
+       [](const Graphs& g, size_t) { shortestpath::BellmanFord<DirectedList>(g.list_d, g.vb); }},
+      {"BellmanFord Matrix", Repr::kMatrix, true, false,
+       [](const Graphs& g, size_t) { shortestpath::BellmanFord<DirectedMatrix>(g.matrix_d, g.vb); }},
+  };
+  return algorithms;
+}
+
+// Estimated memory of both (directed and undirected) graphs in a representation,
+// the undirected matrix keeping only its lower triangle.
+size_t EstimateBytes(const Repr repr, const size_t vertices, const size_t edges) {
+  if (repr == Repr::kMatrix) return DirectedMatrix::EstimateBytes(vertices) + UndirectedMatrix::EstimateBytes(vertices);
+  return 2 * vertices * sizeof(Connections) + 3 * edges * config::kListNodeBytes;
+}
+
+// Reset the peak resident set size of the process, so the next reading covers
+// only what happens from now on. Not every kernel allows it, then the peak is
+// process-wide.
+void ResetPeakRss() {
+  FILE* fp = std::fopen("/proc/self/clear_refs", "w");
+  if (fp == nullptr) return;
+  std::fputs("5", fp);
+  std::fclose(fp);
+}
+
+// Peak resident set size in bytes, or 0 if unknown.
+size_t PeakRss() {
+  FILE* fp = std::fopen("/proc/self/status", "r");
+  if (fp == nullptr) return 0;
+  char line[256];
+  size_t kb = 0;
+  while (std::fgets(line, sizeof(line), fp) != nullptr)
+    if (std::sscanf(line, "VmHWM: %zu kB", &kb) == 1) break;
+  std::fclose(fp);
+  return kb * 1024;
+}
+
+size_t ParseSize(const util::Args& args, const char* name, const size_t default_value) {
+  const char* value = args.GetValue(name);
+  if (value == nullptr) return default_value;
+  char* end;
+  const unsigned long long parsed = std::strtoull(value, &end, 10);
+  return *end == '\0' && parsed > 0 ? parsed : default_value;
+}
+
+// Run `algorithm` until the time budget is exhausted (at least once) and return
+// the number of runs and the total time in seconds.
+std::pair<size_t, double> Measure(const Algorithm& algorithm, const Graphs& g, const size_t threads,
+                                  const double budget_s) {
+  size_t runs = 0;
+  double total_s = 0;
+  do {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    algorithm.run(g, threads);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    total_s += std::chrono::duration<double>(t2 - t1).count();
+    ++runs;
+  } while (total_s < budget_s);
+  return {runs, total_s};
+}
+
+void ScaleDegree(GraphGenerator& graph_gen, const size_t degree, const Options& options) {
+  const auto& algorithms = Algorithms();
+  // Single run time of each algorithm at the previous size, used to skip the
+  // sizes which would not fit in the budget anyway.
+  std::vector<double> last_run_s(algorithms.size(), 0.);
+  std::map<Repr, bool> repr_stopped{{Repr::kList, false}, {Repr::kMatrix, false}};
+  for (size_t vertices = config::kMinVertices; vertices <= options.max_vertices; vertices *= config::kGrowth) {
+    Graphs g;
+    g.vertices = vertices;
+    g.edges = graph_gen.GenerateSparse(vertices, degree, false);
+    g.edges_d = graph_gen.GenerateSparse(vertices, degree, true, &g.vb);
+    for (auto& [repr, stopped] : repr_stopped) {
+      if (stopped) continue;
+      const size_t estimate = EstimateBytes(repr, vertices, g.edges.size());
+      if (options.mem_cap && estimate > options.mem_cap) {
+        std::printf(
+            "vertices= %8zu degree= %2zu | %s representation stopped, estimated %.1f MB exceeds the %.1f MB cap\n",
+            vertices, degree, repr == Repr::kList ? "List" : "Matrix", estimate / 1e6, options.mem_cap / 1e6);
+        stopped = true;
+      }
+    }
+    if (repr_stopped[Repr::kList] && repr_stopped[Repr::kMatrix]) return;
+    if (!repr_stopped[Repr::kList]) {
+      g.list = std::make_shared<UndirectedList>(vertices);
+      g.list_d = std::make_shared<DirectedList>(vertices);
+      g.list->AddEdges(g.edges, Duplicates::kKeep, options.threads);
+      g.list_d->AddEdges(g.edges_d, Duplicates::kKeep, options.threads);
+    }
+    if (!repr_stopped[Repr::kMatrix]) {
+      g.matrix = std::make_shared<UndirectedMatrix>(vertices);
+      g.matrix_d = std::make_shared<DirectedMatrix>(vertices);
+      g.matrix->AddEdges(g.edges, Duplicates::kKeep, options.threads);
+      g.matrix_d->AddEdges(g.edges_d, Duplicates::kKeep, options.threads);
+    }
+    for (size_t i = 0; i < algorithms.size(); ++i) {
+      const Algorithm& algorithm = algorithms[i];
+      if (repr_stopped[algorithm.repr] || last_run_s[i] < 0) continue;
+      // Assume at most quadratic growth in the number of vertices.
+      if (last_run_s[i] * config::kGrowth * config::kGrowth > config::kOverrun * options.budget_s) {
+        std::printf("vertices= %8zu degree= %2zu | %-18s stopped, a single run is predicted to exceed the budget\n",
+                    vertices, degree, algorithm.label);
+        last_run_s[i] = -1;
+        continue;
+      }
+      const size_t edges_no = algorithm.directed ? g.edges_d.size() : g.edges.size();
+      const size_t max_threads = algorithm.parallel ? options.threads : 1;
+      for (size_t threads = 1; threads <= max_threads; ++threads) {
+        ResetPeakRss();
+        const auto [runs, total_s] = Measure(algorithm, g, threads, options.budget_s);
+        const double run_s = total_s / runs;
+        if (threads == 1) last_run_s[i] = run_s;
+        std::printf("vertices= %8zu degree= %2zu threads= %2zu | %-18s time= %11.3f ms edges/s= %8.2f M "
+                    "peak_rss= %8.1f MB runs= %zu\n",
+                    vertices, degree, threads, algorithm.label, run_s * 1e3, edges_no / run_s / 1e6, PeakRss() / 1e6,
+                    runs);
+        std::fflush(stdout);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+size_t PhysicalMemory() {
+  const long pages = ::sysconf(_SC_PHYS_PAGES);
+  const long page_size = ::sysconf(_SC_PAGE_SIZE);
+  return pages > 0 && page_size > 0 ? static_cast<size_t>(pages) * page_size : 0;
+}
+
+bool Scaling(const util::Args& args) {
+  GraphGenerator graph_gen(args.IsFlag("random"));
+  Options options;
+  options.max_vertices = ParseSize(args, "max-vertices", config::kMaxVertices);
+  options.budget_s = ParseSize(args, "budget", config::kBudgetMs) / 1e3;
+  options.threads = ParseSize(args, "threads", std::max(1u, std::thread::hardware_concurrency()));
+  options.mem_cap = ParseSize(args, "mem-cap", PhysicalMemory() / 2 / (1 << 20)) * (1 << 20);
+  std::printf("Scaling, max vertices= %zu, budget= %.0f ms, threads= %zu, memory cap= %.1f MB\n", options.max_vertices,
+              options.budget_s * 1e3, options.threads, options.mem_cap / 1e6);
+  for (const size_t degree : config::kDegrees) ScaleDegree(graph_gen, degree, options);
+  return true;
+}
+
+}  // namespace sdizo::test
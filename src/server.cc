@@ -0,0 +1,532 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// Query server over a Unix domain socket. The graph is loaded once and queried
+// by any number of concurrent clients with a line protocol, one request per
+// line:
+//
+//   dijkstra <vstart>          ok <distance of every vertex, `inf` if unreachable>
+//   bellmanford <vstart>       ok <distances as above> | err negative cycle
+//   path <vstart> <vend>       ok <distance> <vertices of the path> | ok inf
+//   mst                        ok <cost> <u v w of every tree edge>
+//   stats                      ok <n>, then n lines of per-command latencies
+//   quit                       Close the connection.
+//   shutdown                   Stop the server.
+//
+// With --compact-ids the vertices are the labels of the input, and every
+// distance is given as a <label>:<distance> pair, the pairs in the order of the
+// first appearance of the labels in the input.
+//
+// Every request is answered by a single line (`stats` by a header line and its
+// body) starting with `ok` or `err`. A client may pipeline requests: they run
+// concurrently on the worker pool, the responses come back in request order.
+// Directed queries see the edges of the input as arcs, `mst` as undirected
+// edges.
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "args.hpp"
+#include "dheap.hpp"
+#include "graph.hpp"
+#include "graphreader.hpp"
+#include "idmap.hpp"
+#include "mst.hpp"
+#include "output.hpp"
+#include "shortestpath.hpp"
+#include "test.hpp"
+
+namespace sdizo::test {
+namespace {
+namespace config {
+
+constexpr int kBacklog = 64;
+constexpr size_t kMaxLine = 4096;
+constexpr size_t kReadChunk = 1 << 16;
+constexpr int kPollMs = 200;  // Period of checking for a stop signal.
+constexpr size_t kBuckets = 32;
+
+}  // namespace config
+
+using std::operator""sv;
+using Clock = std::chrono::steady_clock;
+
+volatile std::sig_atomic_t stop_signal = 0;
+
+void OnStopSignal(int) { stop_signal = 1; }
+
+using output::Append;
+
+// Split off the next space separated token of `line`, return false at its end.
+bool NextToken(std::string_view& line, std::string_view& token) {
+  const size_t begin = line.find_first_not_of(' ');
+  if (begin == line.npos) return false;
+  line.remove_prefix(begin);
+  const size_t end = std::min(line.find(' '), line.size());
+  token = line.substr(0, end);
+  line.remove_prefix(end);
+  return true;
+}
+
+// Latencies of one command, bucket i counts the ones in [2^i, 2^(i+1))
+// microseconds, the first one also those below a microsecond.
+class Histogram {
+ public:
+  void Record(const uint64_t us) {
+    size_t bucket = 0;
+    while (bucket + 1 < config::kBuckets && (us >> (bucket + 1)) != 0) ++bucket;
+    ++buckets_[bucket];
+    ++count_;
+    total_us_ += us;
+    uint64_t max = max_us_.load();
+    while (us > max && !max_us_.compare_exchange_weak(max, us)) {
+    }
+  }
+
+  // Append "count= .. mean= .. p50< .. p99< .. max= .. | <bucket>:<count> ...",
+  // the percentiles as the upper bounds of their buckets, in microseconds.
+  void Append(std::string& out) const {
+    std::array<uint64_t, config::kBuckets> buckets;
+    for (size_t i = 0; i < buckets.size(); ++i) buckets[i] = buckets_[i].load();
+    const uint64_t count = count_.load();
+    const auto percentile = [&](const uint64_t per_mille) -> uint64_t {
+      uint64_t seen = 0;
+      for (size_t i = 0; i < buckets.size(); ++i)
+        if ((seen += buckets[i]) * 1000 >= count * per_mille && seen != 0) return uint64_t{2} << i;
+      return 0;
+    };
+    out += "count= ";
+    output::Append(out, count);
+    out += " mean= ";
+    output::Append(out, count != 0 ? total_us_.load() / count : 0);
+    out += " p50< ";
+    output::Append(out, percentile(500));
+    out += " p99< ";
+    output::Append(out, percentile(990));
+    out += " max= ";
+    output::Append(out, max_us_.load());
+    out += " |";
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      if (buckets[i] == 0) continue;
+      out += ' ';
+      output::Append(out, uint64_t{1} << i);
+      out += ':';
+      output::Append(out, buckets[i]);
+    }
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, config::kBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> total_us_{0};
+  std::atomic<uint64_t> max_us_{0};
+};
+
+// Fixed set of threads running the submitted tasks in order of submission. A
+// task gets the index of the worker running it.
+class WorkerPool {
+ public:
+  using Task = std::function<void(size_t worker)>;
+
+  explicit WorkerPool(const size_t threads) {
+    for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&WorkerPool::Work, this, i);
+  }
+  // Run the pending tasks and join the workers.
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  size_t Size() const { return threads_.size(); }
+
+  void Submit(Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+  }
+
+ private:
+  void Work(const size_t worker) {
+    while (true) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task(worker);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  bool stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+class Server {
+  enum Command { kDijkstra, kBellmanFord, kPath, kMst, kStats, kCommands };
+  static constexpr std::array<const char*, kCommands> kCommandNames = {
+      {"dijkstra", "bellmanford", "path", "mst", "stats"}};
+
+  // Client connection, closed when the last pending response is written.
+  struct Connection {
+    explicit Connection(const int fd) : fd(fd) {}
+    ~Connection() { ::close(fd); }
+
+    const int fd;
+    std::mutex mutex;
+    std::map<uint64_t, std::string> ready;  // Responses waiting for the earlier ones.
+    uint64_t next{0};                        // Sequence number of the next response to write.
+    bool broken{false};                      // The client went away.
+  };
+
+ public:
+  Server(const std::vector<WEdge>& edges, const size_t vertices, const IdMap* ids, const size_t threads)
+      : g_(std::make_shared<DirectedList>(vertices)),
+        g_undirected_(std::make_shared<UndirectedList>(vertices)),
+        ids_(ids),
+        pool_(threads) {
+    g_->AddEdges(edges);
+    g_undirected_->AddEdges(edges);
+    for (size_t i = 0; i < threads; ++i) engines_.push_back(std::make_unique<Engine>(g_));
+  }
+
+  // Accept clients on `path` until the shutdown command or a stop signal.
+  bool Run(const char* path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+      std::fprintf(stderr, "Error: Socket path too long\n");
+      return false;
+    }
+    std::strcpy(address.sun_path, path);
+    // A socket left behind by a previous server is replaced, any other file is
+    // kept.
+    struct stat st;
+    if (::stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) ::unlink(path);
+    listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener_ < 0 || ::bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener_, config::kBacklog) != 0) {
+      std::fprintf(stderr, "Error: Cannot listen on %s: %s\n", path, std::strerror(errno));
+      if (listener_ >= 0) ::close(listener_);
+      return false;
+    }
+    std::printf("Serving %zu vertices on %s with %zu workers\n", g_->VerticesNo(), path, pool_.Size());
+    std::fflush(stdout);
+    pollfd listener{listener_, POLLIN, 0};
+    while (!stop_ && stop_signal == 0) {
+      const int ready = ::poll(&listener, 1, config::kPollMs);
+      if (ready <= 0) continue;
+      const int fd = ::accept(listener_, nullptr, nullptr);
+      if (fd < 0) continue;
+      // Join the clients which are gone.
+      for (auto it = clients_.begin(); it != clients_.end();) {
+        if (!*it->done) {
+          ++it;
+          continue;
+        }
+        it->thread.join();
+        it = clients_.erase(it);
+      }
+      auto connection = std::make_shared<Connection>(fd);
+      auto done = std::make_shared<std::atomic<bool>>(false);
+      std::thread thread([this, connection, done] {
+        ServeClient(connection);
+        *done = true;
+      });
+      clients_.push_back(Client{std::move(thread), connection, std::move(done)});
+    }
+    ::close(listener_);
+    ::unlink(path);
+    // Wake up the clients blocked on reading.
+    for (const Client& client : clients_)
+      if (const auto connection = client.connection.lock()) ::shutdown(connection->fd, SHUT_RD);
+    for (Client& client : clients_) client.thread.join();
+    return true;
+  }
+
+ private:
+  using Distance = Graph<DirectedList>::Distance;
+  using Engine = shortestpath::DijkstraEngine<DirectedList, IndexedQueue>;
+
+  // Thread reading the requests of a connection.
+  struct Client {
+    std::thread thread;
+    std::weak_ptr<Connection> connection;
+    std::shared_ptr<std::atomic<bool>> done;
+  };
+
+  void ServeClient(std::shared_ptr<Connection> connection) {
+    std::string pending;
+    std::vector<char> chunk(config::kReadChunk);
+    uint64_t sequence = 0;
+    while (true) {
+      const ssize_t n = ::recv(connection->fd, chunk.data(), chunk.size(), 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return;
+      pending.append(chunk.data(), n);
+      size_t begin = 0;
+      for (size_t end; (end = pending.find('\n', begin)) != pending.npos; begin = end + 1) {
+        std::string_view line(pending.data() + begin, end - begin);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line == "quit"sv) return;
+        if (line == "shutdown"sv) {
+          stop_ = true;
+          return;
+        }
+        Dispatch(connection, sequence++, std::string(line));
+      }
+      pending.erase(0, begin);
+      if (pending.size() > config::kMaxLine) {
+        Complete(*connection, sequence++, "err line too long\n");
+        return;
+      }
+    }
+  }
+
+  // Answer the request on the worker pool, `stats` right away.
+  void Dispatch(const std::shared_ptr<Connection>& connection, const uint64_t sequence, std::string request) {
+    const Clock::time_point start = Clock::now();
+    std::string_view line(request), token;
+    if (!NextToken(line, token)) {
+      Complete(*connection, sequence, "err empty request\n");
+      return;
+    }
+    Command command = kCommands;
+    for (size_t i = 0; i < kCommands; ++i)
+      if (token == kCommandNames[i]) command = static_cast<Command>(i);
+    if (command == kCommands) {
+      Complete(*connection, sequence, "err unknown command\n");
+      return;
+    }
+    if (command == kStats) {
+      std::string response = Stats();
+      latencies_[kStats].Record(Elapsed(start));
+      Complete(*connection, sequence, std::move(response));
+      return;
+    }
+    pool_.Submit([this, connection, sequence, command, request = std::move(request), start](const size_t worker) {
+      std::string_view arguments(request);
+      std::string_view token;
+      NextToken(arguments, token);
+      std::string response = Execute(command, arguments, worker);
+      latencies_[command].Record(Elapsed(start));
+      Complete(*connection, sequence, std::move(response));
+    });
+  }
+
+  static uint64_t Elapsed(const Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  }
+
+  std::string Execute(const Command command, std::string_view arguments, const size_t worker) {
+    Vertex vb = 0, ve = 0;
+    if (command != kMst) {
+      if (!ParseVertex(arguments, vb)) return "err invalid vertex\n";
+      if (command == kPath && !ParseVertex(arguments, ve)) return "err invalid vertex\n";
+    }
+    std::string response("ok");
+    switch (command) {
+      case kDijkstra:
+        AppendDistances(response, engines_[worker]->Run(vb).second);
+        break;
+      case kBellmanFord: {
+        const auto path_cost = shortestpath::BellmanFord<DirectedList>(g_, vb);
+        if (!path_cost) return "err negative cycle\n";
+        AppendDistances(response, path_cost->second);
+        break;
+      }
+      case kPath: {
+        const auto& [predecessors, distances] = engines_[worker]->Run(vb);
+        if (distances[ve] == shortestpath::kDistanceInf<Distance>) {
+          response += " inf";
+          break;
+        }
+        response += ' ';
+        Append(response, distances[ve]);
+        std::vector<Vertex> path;
+        for (Vertex v = ve; v != vb; v = predecessors[v]) path.push_back(v);
+        path.push_back(vb);
+        for (auto it = path.rbegin(); it != path.rend(); ++it) AppendVertex(response, *it);
+        break;
+      }
+      case kMst: {
+        const auto spanning_tree = mst::Prim<UndirectedList>(g_undirected_);
+        response += ' ';
+        Append(response, detail::SpanningTreeCost(*spanning_tree));
+        for (const auto& [edge, weight] : *spanning_tree) {
+          AppendVertex(response, edge.first);
+          AppendVertex(response, edge.second);
+          response += ' ';
+          Append(response, weight);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    response += '\n';
+    return response;
+  }
+
+  bool ParseVertex(std::string_view& arguments, Vertex& v) const {
+    std::string_view token;
+    uint64_t label;
+    if (!NextToken(arguments, token)) return false;
+    const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), label);
+    if (ec != std::errc() || end != token.data() + token.size()) return false;
+    if (ids_ != nullptr) {
+      size_t id;
+      if (!ids_->Find(label, id)) return false;
+      label = id;
+    }
+    v = label;
+    return v < g_->VerticesNo();
+  }
+
+  void AppendVertex(std::string& out, const Vertex v) const {
+    out += ' ';
+    Append(out, ids_ != nullptr ? ids_->Label(v) : uint64_t{v});
+  }
+
+  // Distances of every vertex, <label>:<distance> pairs with compacted ids.
+  void AppendDistances(std::string& out, const std::pmr::vector<Distance>& distances) const {
+    for (size_t v = 0; v < distances.size(); ++v) {
+      out += ' ';
+      if (ids_ != nullptr) {
+        Append(out, ids_->Label(v));
+        out += ':';
+      }
+      if (distances[v] == shortestpath::kDistanceInf<Distance>)
+        out += "inf";
+      else
+        Append(out, distances[v]);
+    }
+  }
+
+  std::string Stats() const {
+    std::string out("ok ");
+    Append(out, size_t{kCommands});
+    out += '\n';
+    for (size_t i = 0; i < kCommands; ++i) {
+      out += kCommandNames[i];
+      out += ' ';
+      latencies_[i].Append(out);
+      out += '\n';
+    }
+    return out;
+  }
+
+  // Queue the response and write out every one whose predecessors are written.
+  void Complete(Connection& connection, const uint64_t sequence, std::string response) {
+    std::lock_guard<std::mutex> lock(connection.mutex);
+    connection.ready.emplace(sequence, std::move(response));
+    for (auto it = connection.ready.begin(); it != connection.ready.end() && it->first == connection.next;
+         it = connection.ready.erase(it), ++connection.next) {
+      const std::string& out = it->second;
+      for (size_t written = 0; !connection.broken && written < out.size();) {
+        const ssize_t n = ::send(connection.fd, out.data() + written, out.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) connection.broken = true;
+        if (n > 0) written += n;
+      }
+    }
+  }
+
+  std::shared_ptr<DirectedList> g_;
+  std::shared_ptr<UndirectedList> g_undirected_;
+  const IdMap* ids_;
+  std::vector<std::unique_ptr<Engine>> engines_;  // One per worker.
+  std::array<Histogram, kCommands> latencies_;
+  int listener_{-1};
+  std::atomic<bool> stop_{false};
+  std::vector<Client> clients_;
+  // Last, so the workers finish before anything they use is destroyed.
+  WorkerPool pool_;
+};
+
+size_t ParseThreads(const util::Args& args) {
+  const size_t default_value = std::max(1u, std::thread::hardware_concurrency());
+  const char* value = args.GetValue("threads");
+  if (value == nullptr) return default_value;
+  char* end;
+  const unsigned long long parsed = std::strtoull(value, &end, 10);
+  return *end == '\0' && parsed > 0 ? parsed : default_value;
+}
+
+}  // namespace
+
+bool Serve(const util::Args& args) {
+  if (!args.IsOption("input")) {
+    std::fprintf(stderr, "Error: Missing option --input.\n");
+    return false;
+  }
+  GraphReader reader;
+  IdMap id_map;
+  const IdMap* ids = args.IsFlag("compact-ids") ? &id_map : nullptr;
+  if (ids != nullptr) reader.CompactIds(&id_map);
+  size_t v, e, vb, ve;
+  if (!reader.Open(args.GetValue("input"), v, e, &vb, &ve)) return false;
+  std::vector<WEdge> edges;
+  edges.reserve(e);
+  int32_t w;
+  while (reader.ReadEdge(vb, ve, &w)) edges.emplace_back(Edge(vb, ve), w);
+  if (edges.size() != e) return false;
+  if (ids != nullptr) v = ids->Size();
+
+  struct sigaction action {};
+  action.sa_handler = OnStopSignal;
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+  Server server(edges, v, ids, ParseThreads(args));
+  return server.Run(args.GetValue("serve"));
+}
+
+}  // namespace sdizo::test
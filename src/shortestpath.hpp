@@ -20,77 +20,222 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <memory_resource>
+#include <tuple>
 #include <vector>
 
+#include "dheap.hpp"
 #include "graph.hpp"
+#include "instrument.hpp"
+#include "simd.hpp"
 
 namespace sdizo::shortestpath {
 
-constexpr auto kDistanceInf = std::numeric_limits<Weight>::max();
+// Distance of the vertices not reached.
+template <typename D>
+constexpr D kDistanceInf = std::numeric_limits<D>::max();
 
-template <typename GRepr>
-std::unique_ptr<PathCost> Dijkstra(std::shared_ptr<const Graph<GRepr>> g, const Vertex vb) {
-  struct Distance {
-    Distance(const Vertex v, const Weight d) : d_(d), v_(v){};
+// Dijkstra's algorithm which owns its scratch buffers, so repeated queries on
+// the same graph do not allocate. Between runs only the vertices touched by the
+// previous run are reset. The graph must not change during the lifetime of the
+// engine. `Queue` is the priority queue policy, LazyQueue or IndexedQueue.
+template <typename GRepr, template <typename, typename> class Queue = LazyQueue>
+class DijkstraEngine {
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Weight = typename Graph<GRepr>::Weight;
+  using PathCost = typename Graph<GRepr>::PathCost;
+  using Length = typename Graph<GRepr>::Distance;
+  static constexpr Length kInf = kDistanceInf<Length>;
 
-    Weight d_;
-    Vertex v_;
-  };
-  struct distance_sort {
-    bool operator()(Distance const& lhs, Distance const& rhs) const { return lhs.d_ > rhs.d_; }
-  };
-  const size_t vertex_no = g->VerticesNo();
-  std::vector<Vertex> predecessors(vertex_no);
-  std::vector<Weight> distances(vertex_no, kDistanceInf);
-  std::vector<Distance> Q{{vb, 0}};
-  auto adjacents = g->Adj();
-  while (!Q.empty()) {
-    std::pop_heap(Q.begin(), Q.end(), distance_sort{});
-    const Distance distance = Q.back();
-    Q.pop_back();
-    const Vertex& u = distance.v_;
-    if (distance.d_ > distances[u]) continue;
-    distances[u] = distance.d_;
-    for (const auto& [v, weight] : (*adjacents)[u]) {
-      const Weight new_distance = distances[u] + weight;
-      if (new_distance < distances[v]) {
-        Q.push_back({v, new_distance});
-        std::push_heap(Q.begin(), Q.end(), distance_sort{});
-        distances[v] = new_distance;
-        predecessors[v] = u;
+ public:
+  DijkstraEngine(std::shared_ptr<const Graph<GRepr>> g,
+                 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : g_(g),
+        path_cost_(std::piecewise_construct, std::forward_as_tuple(resource), std::forward_as_tuple(resource)),
+        Q_(resource),
+        touched_(resource) {
+    const size_t vertex_no = g->VerticesNo();
+    path_cost_.first.resize(vertex_no);
+    path_cost_.second.resize(vertex_no, kInf);
+    Q_.Resize(vertex_no);
+  }
+
+  // Return the (predecessors, distances) view of the shortest paths from `vb`,
+  // valid until the next run.
+  const PathCost& Run(const Vertex vb) {
+    instrument::Disabled instr;
+    return Run(vb, instr);
+  }
+  template <typename Instr>
+  const PathCost& Run(const Vertex vb, Instr& instr) {
+    Reset();
+    auto& [predecessors, distances] = path_cost_;
+    Q_.Push(vb, 0);
+    instr.HeapPush();
+    touched_.push_back(vb);
+    distances[vb] = 0;
+    while (!Q_.Empty()) {
+      const std::pair<Vertex, Length> top = Q_.Pop();
+      const Vertex u = top.first;
+      instr.HeapPop();
+      if (top.second > distances[u]) {
+        instr.StaleSkip();
+        continue;
       }
+      if (instr.Stop()) break;
+      g_->ForEachNeighbour(u, [&](const Vertex v, const Weight weight) {
+        instr.EdgeScan();
+        const Length new_distance = distances[u] + weight;
+        if (new_distance < distances[v]) {
+          instr.Relaxation();
+          if (Q_.Push(v, new_distance))
+            instr.HeapPush();
+          else
+            instr.DecreaseKey();
+          if (distances[v] == kInf) touched_.push_back(v);
+          distances[v] = new_distance;
+          predecessors[v] = u;
+        }
+      });
     }
+    return path_cost_;
   }
-  return std::make_unique<PathCost>(std::move(predecessors), std::move(distances));
+
+  // Move the result of the last run out of the engine, the engine cannot be
+  // used afterwards.
+  std::unique_ptr<PathCost> Release() { return std::make_unique<PathCost>(std::move(path_cost_)); }
+
+ private:
+  void Reset() {
+    auto& [predecessors, distances] = path_cost_;
+    for (const Vertex v : touched_) {
+      predecessors[v] = 0;
+      distances[v] = kInf;
+    }
+    touched_.clear();
+    Q_.Clear();
+  }
+
+  std::shared_ptr<const Graph<GRepr>> g_;
+  PathCost path_cost_;
+  Queue<Length, Vertex> Q_;
+  std::pmr::vector<Vertex> touched_;
+};
+
+template <typename GRepr, template <typename, typename> class Queue = LazyQueue, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::PathCost> HeapDijkstra(
+    std::shared_ptr<const Graph<GRepr>> g, const typename Graph<GRepr>::Vertex vb, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  DijkstraEngine<GRepr, Queue> engine(g, resource);
+  engine.Run(vb, instr);
+  return engine.Release();
+}
+
+// Dijkstra's algorithm for an AdjacencyMatrix without negative weights in O(V^2)
+// without a heap: the closest vertex is found by a scan over the keys and its
+// matrix row is relaxed as a whole.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::PathCost> DenseDijkstra(
+    std::shared_ptr<const Graph<GRepr>> g, const typename Graph<GRepr>::Vertex vb, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  static_assert(IsAdjacencyMatrix<GRepr>::value);
+  using Vertex = typename Graph<GRepr>::Vertex;
+  using Distance = typename Graph<GRepr>::Distance;
+  constexpr Distance kInf = kDistanceInf<Distance>;
+  // Key of the vertices whose distance is final.
+  constexpr Distance kDone = std::numeric_limits<Distance>::lowest();
+  const GRepr& matrix = static_cast<const GRepr&>(*g);
+  const size_t vertex_no = g->VerticesNo();
+  auto path_cost = std::make_unique<typename Graph<GRepr>::PathCost>(
+      std::piecewise_construct, std::forward_as_tuple(vertex_no, resource),
+      std::forward_as_tuple(vertex_no, kInf, resource));
+  auto& [predecessors, distances] = *path_cost;
+  std::pmr::vector<Distance> keys(vertex_no, kInf, resource);
+  std::pmr::vector<typename Graph<GRepr>::Weight> scratch(matrix.Dimension(), resource);
+  keys[vb] = 0;
+  while (!instr.Stop()) {
+    const auto [distance, u] = simd::ArgMin(keys.data(), vertex_no, kDone, kInf);
+    if (distance == kInf) break;
+    distances[u] = distance;
+    keys[u] = kDone;
+    instr.EdgeScan(vertex_no);
+    simd::RelaxRow(matrix.Row(u, scratch.data()), vertex_no, distance, keys.data(), [&](const size_t v) {
+      instr.Relaxation();
+      predecessors[v] = static_cast<Vertex>(u);
+    });
+  }
+  return path_cost;
+}
+
+// DenseDijkstra for an AdjacencyMatrix without negative weights, HeapDijkstra
+// otherwise.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::PathCost> Dijkstra(
+    std::shared_ptr<const Graph<GRepr>> g, const typename Graph<GRepr>::Vertex vb, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  if constexpr (IsAdjacencyMatrix<GRepr>::value)
+    if (!static_cast<const GRepr&>(*g).HasNegativeWeights()) return DenseDijkstra<GRepr>(g, vb, instr, resource);
+  return HeapDijkstra<GRepr>(g, vb, instr, resource);
 }
 
 template <typename GRepr>
-std::unique_ptr<PathCost> BellmanFord(std::shared_ptr<const Graph<GRepr>> g, const Vertex vb) {
+std::unique_ptr<typename Graph<GRepr>::PathCost> Dijkstra(std::shared_ptr<const Graph<GRepr>> g,
+                                                          const typename Graph<GRepr>::Vertex vb) {
+  instrument::Disabled instr;
+  return Dijkstra<GRepr>(g, vb, instr);
+}
+
+// Bellman-Ford algorithm pulling, in every round, the best distance of each
+// vertex through its incoming arcs, which are scanned as contiguous arrays.
+// Return nullptr if there is a negative cycle reachable from `vb`.
+template <typename GRepr, typename Instr>
+std::unique_ptr<typename Graph<GRepr>::PathCost> BellmanFord(
+    std::shared_ptr<const Graph<GRepr>> g, const typename Graph<GRepr>::Vertex vb, Instr& instr,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+  using PathCost = typename Graph<GRepr>::PathCost;
+  using Distance = typename Graph<GRepr>::Distance;
+  constexpr Distance kInf = kDistanceInf<Distance>;
   const size_t vertex_no = g->VerticesNo();
-  auto edges = g->Edges();
-  std::vector<Vertex> predecessors(vertex_no);
-  std::vector<Weight> distances(vertex_no);
-  std::fill(distances.begin(), distances.end(), kDistanceInf);
+  const auto arcs = g->EdgesByTarget();
+  std::pmr::vector<typename Graph<GRepr>::Vertex> predecessors(vertex_no, resource);
+  std::pmr::vector<Distance> distances(vertex_no, resource);
+  std::fill(distances.begin(), distances.end(), kInf);
   distances[vb] = 0;
-  for (size_t i = 0; i < vertex_no - 1; ++i) {
+  // Lower every distance to the best one through an incoming arc, return whether
+  // any changed.
+  const auto relax = [&]() -> bool {
     bool change = false;
-    for (const auto& [edge, weight] : *edges) {
-      const auto& [u, v] = edge;
-      if (distances[u] != kDistanceInf && distances[u] + weight < distances[v]) {
+    for (size_t v = 0; v < vertex_no; ++v) {
+      const size_t first = arcs->offsets[v];
+      const size_t last = arcs->offsets[v + 1];
+      instr.EdgeScan(last - first);
+      const auto [distance, i] =
+          simd::MinIncoming(arcs->src.data(), arcs->w.data(), distances.data(), first, last, kInf);
+      if (distance < distances[v]) {
+        instr.Relaxation();
         change = true;
-        distances[v] = distances[u] + weight;
-        predecessors[v] = u;
+        distances[v] = distance;
+        predecessors[v] = arcs->src[i];
       }
     }
-    if (!change) goto no_negative_cycle;
+    return change;
+  };
+  for (size_t i = 0; i + 1 < vertex_no; ++i) {
+    instr.Round();
+    if (instr.Stop() || !relax()) goto no_negative_cycle;
   }
-  for (const auto& [edge, weight] : *edges)
-    if (distances[edge.first] + weight < distances[edge.second])
-      return std::unique_ptr<PathCost>(nullptr);  // Negative cycle
+  if (relax()) return std::unique_ptr<PathCost>(nullptr);  // Negative cycle
 no_negative_cycle:
   return std::make_unique<PathCost>(std::move(predecessors), std::move(distances));
 }
 
+template <typename GRepr>
+std::unique_ptr<typename Graph<GRepr>::PathCost> BellmanFord(std::shared_ptr<const Graph<GRepr>> g,
+                                                             const typename Graph<GRepr>::Vertex vb) {
+  instrument::Disabled instr;
+  return BellmanFord<GRepr>(g, vb, instr);
+}
+
 }  // namespace sdizo::shortestpath
 
 #endif  // SDIZO_SHORTESTPATH_HPP_
@@ -0,0 +1,190 @@
+// This file is part of the sdizograph distribution.
+// Copyright (c) 2022 Damian Zimon <damianzim>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef SDIZO_SIMD_HPP_
+#define SDIZO_SIMD_HPP_
+
+#include <cinttypes>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace sdizo::simd {
+
+#ifdef __AVX2__
+namespace detail {
+
+// dist[src[0]], ..., dist[src[7]] for 32-bit or 64-bit vertex ids.
+template <typename V>
+__m256i Gather8(const int32_t* dist, const V* src) {
+  if constexpr (sizeof(V) == sizeof(int32_t)) {
+    return _mm256_i32gather_epi32(dist, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), 4);
+  } else {
+    const __m128i lo = _mm256_i64gather_epi32(dist, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), 4);
+    const __m128i hi = _mm256_i64gather_epi32(dist, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4)), 4);
+    return _mm256_set_m128i(hi, lo);
+  }
+}
+
+// w[0], ..., w[7] widened to 32 bits.
+template <typename W>
+__m256i Load8(const W* w) {
+  if constexpr (sizeof(W) == sizeof(int32_t))
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w));
+  else
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w)));
+}
+
+}  // namespace detail
+#endif
+
+// The lowest dist[src[i]] + w[i] over the positions [first, last), skipping the
+// sources whose distance is `inf`, and the first position attaining it. Return
+// (inf, first) if there is none. With AVX2, 32-bit distances are reduced eight
+// positions at a time with gathers and branchless selects.
+template <typename V, typename W, typename D>
+std::pair<D, size_t> MinIncoming(const V* src, const W* w, const D* dist, const size_t first, const size_t last,
+                                 const D inf) {
+  D best = inf;
+  size_t arg = first;
+  size_t i = first;
+#ifdef __AVX2__
+  if constexpr (std::is_same_v<D, int32_t> && (sizeof(W) == 2 || sizeof(W) == 4) &&
+                (sizeof(V) == 4 || sizeof(V) == 8)) {
+    if (last - first >= 8) {
+      const __m256i vinf = _mm256_set1_epi32(inf);
+      const __m256i step = _mm256_set1_epi32(8);
+      __m256i vbest = vinf;
+      __m256i varg = _mm256_setzero_si256();
+      __m256i vpos = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);  // Relative to `first`.
+      for (; i + 8 <= last; i += 8) {
+        const __m256i du = detail::Gather8(dist, src + i);
+        const __m256i unreachable = _mm256_cmpeq_epi32(du, vinf);
+        const __m256i candidate = _mm256_blendv_epi8(_mm256_add_epi32(du, detail::Load8(w + i)), vinf, unreachable);
+        const __m256i better = _mm256_cmpgt_epi32(vbest, candidate);
+        vbest = _mm256_blendv_epi8(vbest, candidate, better);
+        varg = _mm256_blendv_epi8(varg, vpos, better);
+        vpos = _mm256_add_epi32(vpos, step);
+      }
+      alignas(32) int32_t bests[8];
+      alignas(32) int32_t args[8];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(bests), vbest);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(args), varg);
+      for (size_t lane = 0; lane < 8; ++lane) {
+        const size_t position = first + args[lane];
+        if (bests[lane] < best || (bests[lane] == best && best != inf && position < arg)) {
+          best = bests[lane];
+          arg = position;
+        }
+      }
+    }
+  }
+#endif
+  for (; i < last; ++i) {
+    const D du = dist[src[i]];
+    const D candidate = du == inf ? inf : static_cast<D>(du + w[i]);
+    const bool better = candidate < best;
+    best = better ? candidate : best;
+    arg = better ? i : arg;
+  }
+  return {best, arg};
+}
+
+// The first position of the lowest key in [0, n), treating the keys equal to
+// `skip` as `inf`, and that key. Return (inf, n) if every key is `inf`. With
+// AVX2, 32-bit keys are compared eight at a time.
+template <typename D>
+std::pair<D, size_t> ArgMin(const D* keys, const size_t n, const D skip, const D inf) {
+  D best = inf;
+  size_t arg = n;
+  size_t i = 0;
+#ifdef __AVX2__
+  if constexpr (std::is_same_v<D, int32_t>) {
+    if (n >= 8) {
+      const __m256i vinf = _mm256_set1_epi32(inf);
+      const __m256i vskip = _mm256_set1_epi32(skip);
+      const __m256i step = _mm256_set1_epi32(8);
+      __m256i vbest = vinf;
+      __m256i varg = _mm256_set1_epi32(-1);
+      __m256i vpos = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      for (; i + 8 <= n; i += 8) {
+        __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        key = _mm256_blendv_epi8(key, vinf, _mm256_cmpeq_epi32(key, vskip));
+        const __m256i better = _mm256_cmpgt_epi32(vbest, key);
+        vbest = _mm256_blendv_epi8(vbest, key, better);
+        varg = _mm256_blendv_epi8(varg, vpos, better);
+        vpos = _mm256_add_epi32(vpos, step);
+      }
+      alignas(32) int32_t bests[8];
+      alignas(32) int32_t args[8];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(bests), vbest);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(args), varg);
+      for (size_t lane = 0; lane < 8; ++lane)
+        if (bests[lane] < best || (bests[lane] == best && best != inf && static_cast<size_t>(args[lane]) < arg)) {
+          best = bests[lane];
+          arg = args[lane];
+        }
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    const D key = keys[i] == skip ? inf : keys[i];
+    const bool better = key < best;
+    best = better ? key : best;
+    arg = better ? i : arg;
+  }
+  return {best, arg};
+}
+
+// Lower keys[v] to base + row[v] for every v in [0, n) with a nonzero row[v],
+// where it is lower, and call improved(v) for each such v. A key equal to the
+// lowest value of D is never lowered. With AVX2, 32-bit keys with 16/32-bit
+// weights are relaxed eight at a time.
+template <typename W, typename D, typename Fn>
+void RelaxRow(const W* row, const size_t n, const D base, D* keys, Fn improved) {
+  size_t i = 0;
+#ifdef __AVX2__
+  if constexpr (std::is_same_v<D, int32_t> && (sizeof(W) == 2 || sizeof(W) == 4)) {
+    const __m256i vbase = _mm256_set1_epi32(base);
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+      const __m256i w = detail::Load8(row + i);
+      const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+      const __m256i candidate = _mm256_add_epi32(vbase, w);
+      const __m256i better = _mm256_andnot_si256(_mm256_cmpeq_epi32(w, zero), _mm256_cmpgt_epi32(key, candidate));
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(better));
+      if (mask == 0) continue;
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_blendv_epi8(key, candidate, better));
+      for (; mask != 0; mask &= mask - 1) improved(i + __builtin_ctz(mask));
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    const D candidate = static_cast<D>(base + row[i]);
+    if (row[i] != 0 && candidate < keys[i]) {
+      keys[i] = candidate;
+      improved(i);
+    }
+  }
+}
+
+}  // namespace sdizo::simd
+
+#endif  // SDIZO_SIMD_HPP_
@@ -17,13 +17,23 @@
 #ifndef SDIZO_TEST_HPP_
 #define SDIZO_TEST_HPP_
 
+#include <cstddef>
+
 #include "args.hpp"
 
 namespace sdizo::test {
 
+bool Batch(const util::Args& args);
+bool Benchmark(const util::Args& args);
 bool Example(const util::Args& args);
 bool Functional(const util::Args& args);
+bool Generate(const util::Args& args);
 bool Performance(const util::Args& args);
+bool Scaling(const util::Args& args);
+bool Serve(const util::Args& args);
+
+// Physical memory of the machine in bytes, 0 if unknown.
+size_t PhysicalMemory();
 
 }  // namespace sdizo::test
 